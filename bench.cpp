@@ -0,0 +1,267 @@
+#include "chess.h"
+#include "search.h"
+#include "timer.h"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+
+// middlegame and endgame positions every benchmark runs on
+static const char* positions[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r1bq1rk1/pp2bppp/2n1pn2/3p4/2PP4/2N1PN2/PP1B1PPP/R2QKB1R w KQ - 0 8",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - 0 1"
+};
+
+static void usage()
+{
+    std::cout << "usage: bench smp [-l] [depth] [max threads]   time to depth and nodes/sec at 1, 2, 4, ... threads, -l with huge pages for the hash" << std::endl;
+    std::cout << "       bench nnue [weights file]              network evaluations/sec for every SIMD path" << std::endl;
+    std::cout << "       bench order [depth]                    nodes to depth with and without killer/counter/history ordering" << std::endl;
+    std::cout << "       bench pawns [depth]                    evaluations/sec over every node to depth with and without the pawn hash" << std::endl;
+}
+
+static int benchSmp(int depth, int max_threads, bool large_pages)
+{
+    std::cout << "threads    time(s)        nodes          nps   speedup" << std::endl;
+
+    double base_time = 0;
+
+    for (int threads = 1; threads <= max_threads; threads *= 2)
+    {
+        std::uint64_t nodes = 0;
+        double time = 0;
+
+        for (const char* fen : positions)
+        {
+            Chess game;
+            game.fromFEN(fen);
+
+            TranspositionTable tt(64, large_pages);
+
+            SearchLimits limits;
+            limits.depth = depth;
+            limits.threads = threads;
+
+            auto start = std::chrono::steady_clock::now();
+            SearchResult result = Search(game, tt).run(limits);
+            time += seconds(start);
+            nodes += result.nodes;
+        }
+
+        if (threads == 1)
+        {
+            base_time = time;
+        }
+
+        std::cout << std::setw(7) << threads << std::setw(11) << std::fixed << std::setprecision(3) << time
+            << std::setw(13) << nodes << std::setw(13) << static_cast<std::uint64_t>(nodes / time)
+            << std::setw(10) << std::setprecision(2) << base_time / time << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+// nodes to a fixed depth with the hash move and MVV-LVA captures only, then with
+// killers, counter moves and history on top, on a fresh hash table each time
+static int benchOrder(int depth)
+{
+    std::cout << "position     baseline       staged   reduction" << std::endl;
+
+    std::uint64_t total[2] = {0, 0};
+    int index = 0;
+
+    for (const char* fen : positions)
+    {
+        std::uint64_t nodes[2] = {0, 0};
+
+        for (int ordering = 0; ordering < 2; ++ordering)
+        {
+            Chess game;
+            game.fromFEN(fen);
+
+            TranspositionTable tt(64);
+
+            SearchLimits limits;
+            limits.depth = depth;
+            limits.quiet_ordering = ordering;
+
+            nodes[ordering] = Search(game, tt).run(limits).nodes;
+            total[ordering] += nodes[ordering];
+        }
+
+        std::cout << std::setw(8) << ++index << std::setw(13) << nodes[0] << std::setw(13) << nodes[1]
+            << std::setw(11) << std::fixed << std::setprecision(1) << 100.0 * (1.0 - double(nodes[1]) / nodes[0]) << "%" << std::endl;
+    }
+
+    std::cout << std::setw(8) << "total" << std::setw(13) << total[0] << std::setw(13) << total[1]
+        << std::setw(11) << std::fixed << std::setprecision(1) << 100.0 * (1.0 - double(total[1]) / total[0]) << "%" << std::endl;
+
+    return EXIT_SUCCESS;
+}
+
+// Every position is evaluated after each legal move and again after taking it
+// back, so the timing covers the incremental accumulator update as well as the
+// output layer. The checksum must not depend on the SIMD path.
+static int benchNnue(const std::string& weights)
+{
+    Network network;
+
+    if (weights.empty())
+    {
+        std::cout << "no weights file given, using random weights" << std::endl;
+        network.randomize(2024);
+    }
+
+    else if (!network.load(weights))
+    {
+        std::cout << "cannot load " << weights << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const SimdLevel levels[] = {SimdLevel::Scalar, SimdLevel::Sse41, SimdLevel::Avx2};
+    const int rounds = 2000;
+
+    std::cout << "kernel          evals/s     checksum" << std::endl;
+
+    for (SimdLevel level : levels)
+    {
+        if (!network.setSimdLevel(level))
+        {
+            std::cout << std::setw(6) << Network::levelName(level) << "      not supported" << std::endl;
+            continue;
+        }
+
+        std::uint64_t evals = 0;
+        std::int64_t checksum = 0;
+        double time = 0;
+
+        for (const char* fen : positions)
+        {
+            Chess game;
+            game.fromFEN(fen);
+            game.setNetwork(&network);
+
+            MoveList moves;
+            game.generateMoves(moves);
+
+            auto start = std::chrono::steady_clock::now();
+            for (int round = 0; round < rounds; ++round)
+            {
+                for (const Move& move : moves)
+                {
+                    game.doMove(move);
+                    checksum += game.evaluate();
+                    game.undoMove();
+                    checksum += game.evaluate();
+                }
+            }
+            time += seconds(start);
+            evals += 2ULL * rounds * moves.size();
+        }
+
+        std::cout << std::setw(6) << Network::levelName(level) << std::setw(17) << static_cast<std::uint64_t>(evals / time)
+            << std::setw(13) << checksum << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+// evaluates every node of the tree below game, like perft but summing the scores
+static std::int64_t evaluateTree(Chess& game, int depth, PawnTable* pawn_table, std::uint64_t& evals)
+{
+    std::int64_t checksum = game.evaluate(pawn_table);
+    ++evals;
+
+    if (depth == 0)
+    {
+        return checksum;
+    }
+
+    MoveList moves;
+    game.generateMoves(moves);
+
+    for (const Move& move : moves)
+    {
+        game.doMove(move);
+        checksum += evaluateTree(game, depth - 1, pawn_table, evals);
+        game.undoMove();
+    }
+
+    return checksum;
+}
+
+static int benchPawns(int depth)
+{
+    std::cout << "pawn hash        evals/s     checksum   hit rate" << std::endl;
+
+    for (int cached = 0; cached < 2; ++cached)
+    {
+        PawnTable pawn_table;
+        std::uint64_t evals = 0;
+        std::int64_t checksum = 0;
+        double time = 0;
+
+        for (const char* fen : positions)
+        {
+            Chess game;
+            game.fromFEN(fen);
+
+            auto start = std::chrono::steady_clock::now();
+            checksum += evaluateTree(game, depth, cached ? &pawn_table : nullptr, evals);
+            time += seconds(start);
+        }
+
+        std::cout << std::setw(9) << (cached ? "on" : "off") << std::setw(15) << static_cast<std::uint64_t>(evals / time)
+            << std::setw(13) << checksum;
+
+        if (cached)
+        {
+            std::cout << std::setw(10) << std::fixed << std::setprecision(1)
+                << 100.0 * pawn_table.hits() / pawn_table.probes() << "%";
+        }
+
+        std::cout << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char* argv[])
+{
+    std::string command = argc > 1 ? argv[1] : "";
+
+    if (command == "smp")
+    {
+        bool large_pages = argc > 2 && std::string(argv[2]) == "-l";
+        int arg = large_pages ? 3 : 2;
+
+        int depth = argc > arg ? std::atoi(argv[arg]) : 10;
+        int max_threads = argc > arg + 1 ? std::atoi(argv[arg + 1]) : 16;
+
+        return benchSmp(depth, max_threads, large_pages);
+    }
+
+    if (command == "order")
+    {
+        return benchOrder(argc > 2 ? std::atoi(argv[2]) : 9);
+    }
+
+    if (command == "pawns")
+    {
+        return benchPawns(argc > 2 ? std::atoi(argv[2]) : 4);
+    }
+
+    if (command == "nnue")
+    {
+        return benchNnue(argc > 2 ? argv[2] : "");
+    }
+
+    usage();
+    return EXIT_FAILURE;
+}
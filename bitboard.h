@@ -0,0 +1,251 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <cstdint>
+
+#if defined(__x86_64__) && defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+// one bit per square, a1 = bit 0, b1 = bit 1, ..., h8 = bit 63
+using Bitboard = std::uint64_t;
+
+constexpr int SQUARE_NB = 64;
+constexpr int NO_SQUARE = -1;
+
+constexpr int makeSquare(int file, int rank)
+{
+    return rank * 8 + file;
+}
+
+constexpr int fileOf(int square)
+{
+    return square & 7;
+}
+
+constexpr int rankOf(int square)
+{
+    return square >> 3;
+}
+
+constexpr Bitboard squareBit(int square)
+{
+    return Bitboard(1) << square;
+}
+
+inline int lsb(Bitboard b)
+{
+    return __builtin_ctzll(b);
+}
+
+inline int popLsb(Bitboard& b)
+{
+    int square = lsb(b);
+    b &= b - 1;
+    return square;
+}
+
+inline int popCount(Bitboard b)
+{
+    return __builtin_popcountll(b);
+}
+
+inline bool moreThanOne(Bitboard b)
+{
+    return b & (b - 1);
+}
+
+// knight, king and pawn attacks from every square, built by the compiler
+struct LeaperAttacks {
+    Bitboard knight[SQUARE_NB];
+    Bitboard king[SQUARE_NB];
+    Bitboard pawn[2][SQUARE_NB]; // [FigureColor], squares a pawn of that color attacks
+};
+
+constexpr Bitboard leaperAttacks(int square, const int (&delta_file)[8], const int (&delta_rank)[8], int count)
+{
+    Bitboard attacks = 0;
+
+    for (int i = 0; i < count; ++i)
+    {
+        int file = fileOf(square) + delta_file[i];
+        int rank = rankOf(square) + delta_rank[i];
+
+        if (0 <= file && file < 8 && 0 <= rank && rank < 8)
+        {
+            attacks |= squareBit(makeSquare(file, rank));
+        }
+    }
+
+    return attacks;
+}
+
+constexpr LeaperAttacks makeLeaperAttacks()
+{
+    const int knight_file[8] = {2, 2, -2, -2, 1, 1, -1, -1};
+    const int knight_rank[8] = {1, -1, 1, -1, 2, -2, 2, -2};
+
+    const int king_file[8] = {-1, 0, 1, -1, 1, -1, 0, 1};
+    const int king_rank[8] = {-1, -1, -1, 0, 0, 1, 1, 1};
+
+    const int pawn_file[8] = {-1, 1};
+    const int white_pawn_rank[8] = {1, 1};
+    const int black_pawn_rank[8] = {-1, -1};
+
+    LeaperAttacks attacks = {};
+
+    for (int square = 0; square < SQUARE_NB; ++square)
+    {
+        attacks.knight[square] = leaperAttacks(square, knight_file, knight_rank, 8);
+        attacks.king[square] = leaperAttacks(square, king_file, king_rank, 8);
+        attacks.pawn[0][square] = leaperAttacks(square, pawn_file, white_pawn_rank, 2);
+        attacks.pawn[1][square] = leaperAttacks(square, pawn_file, black_pawn_rank, 2);
+    }
+
+    return attacks;
+}
+
+inline constexpr LeaperAttacks leaper_attacks = makeLeaperAttacks();
+
+constexpr Bitboard knightAttacks(int square)
+{
+    return leaper_attacks.knight[square];
+}
+
+constexpr Bitboard kingAttacks(int square)
+{
+    return leaper_attacks.king[square];
+}
+
+// squares attacked by a pawn of color standing on square
+constexpr Bitboard pawnAttacks(int color, int square)
+{
+    return leaper_attacks.pawn[color][square];
+}
+
+static_assert(knightAttacks(0) == (squareBit(10) | squareBit(17)), "knight on a1 attacks c2 and b3");
+static_assert(pawnAttacks(1, 9) == (squareBit(0) | squareBit(2)), "black pawn on b2 attacks a1 and c1");
+
+// Slider attacks come from one table lookup per piece. The occupancy bits that
+// matter (mask) are turned into a table index either with a magic multiply or,
+// in builds for BMI2 (-mbmi2, -march=native) with PEXT, unless the host turns
+// out to have a slow one; initBitboards() picks at runtime.
+struct Magic {
+    Bitboard mask;
+    Bitboard magic;
+    Bitboard* attacks;
+    unsigned shift;
+};
+
+extern Magic rook_magics[SQUARE_NB];
+extern Magic bishop_magics[SQUARE_NB];
+extern bool use_pext;
+
+inline unsigned magicIndex(const Magic& m, Bitboard occupied)
+{
+#if defined(__x86_64__) && defined(__BMI2__)
+    if (use_pext)
+    {
+        return static_cast<unsigned>(_pext_u64(occupied, m.mask));
+    }
+#endif
+
+    return static_cast<unsigned>(((occupied & m.mask) * m.magic) >> m.shift);
+}
+
+inline Bitboard rookAttacks(int square, Bitboard occupied)
+{
+    const Magic& m = rook_magics[square];
+    return m.attacks[magicIndex(m, occupied)];
+}
+
+inline Bitboard bishopAttacks(int square, Bitboard occupied)
+{
+    const Magic& m = bishop_magics[square];
+    return m.attacks[magicIndex(m, occupied)];
+}
+
+inline Bitboard queenAttacks(int square, Bitboard occupied)
+{
+    return rookAttacks(square, occupied) | bishopAttacks(square, occupied);
+}
+
+void initBitboards(); // fills the slider tables, Chess::Chess() calls it once
+
+Bitboard rayAttacks(int square, Bitboard occupied, int delta_file, int delta_rank);
+
+// squares between two squares on a rank, file or diagonal, and the whole line
+// through them; both empty when the squares are not aligned
+struct LineTables {
+    Bitboard between[SQUARE_NB][SQUARE_NB]; // strictly between from and to
+    Bitboard line[SQUARE_NB][SQUARE_NB]; // edge to edge, from and to included
+};
+
+constexpr LineTables makeLineTables()
+{
+    LineTables tables = {};
+
+    for (int from = 0; from < SQUARE_NB; ++from)
+    {
+        for (int dir_file = -1; dir_file <= 1; ++dir_file)
+        {
+            for (int dir_rank = -1; dir_rank <= 1; ++dir_rank)
+            {
+                if (dir_file == 0 && dir_rank == 0)
+                {
+                    continue;
+                }
+
+                // the full line through from in this direction and the opposite one
+                Bitboard line = squareBit(from);
+                for (int sign = -1; sign <= 1; sign += 2)
+                {
+                    int file = fileOf(from) + sign * dir_file;
+                    int rank = rankOf(from) + sign * dir_rank;
+
+                    while (0 <= file && file < 8 && 0 <= rank && rank < 8)
+                    {
+                        line |= squareBit(makeSquare(file, rank));
+                        file += sign * dir_file;
+                        rank += sign * dir_rank;
+                    }
+                }
+
+                Bitboard path = 0;
+                int file = fileOf(from) + dir_file;
+                int rank = rankOf(from) + dir_rank;
+
+                while (0 <= file && file < 8 && 0 <= rank && rank < 8)
+                {
+                    int to = makeSquare(file, rank);
+                    tables.between[from][to] = path;
+                    tables.line[from][to] = line;
+
+                    path |= squareBit(to);
+                    file += dir_file;
+                    rank += dir_rank;
+                }
+            }
+        }
+    }
+
+    return tables;
+}
+
+inline constexpr LineTables line_tables = makeLineTables();
+
+constexpr Bitboard between(int from, int to)
+{
+    return line_tables.between[from][to];
+}
+
+constexpr Bitboard line(int from, int to)
+{
+    return line_tables.line[from][to];
+}
+
+static_assert(between(4, 7) == (squareBit(5) | squareBit(6)), "f1 and g1 lie between e1 and h1");
+static_assert(line(0, 9) == 0x8040201008040201ULL, "a1 and b2 share the long diagonal");
+static_assert(between(0, 10) == 0 && line(0, 10) == 0, "a1 and c2 are not aligned");
+
+#endif
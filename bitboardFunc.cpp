@@ -0,0 +1,165 @@
+#include "bitboard.h"
+
+Magic rook_magics[SQUARE_NB];
+Magic bishop_magics[SQUARE_NB];
+bool use_pext = false;
+
+static Bitboard rook_table[0x19000];
+static Bitboard bishop_table[0x1480];
+
+static bool onBoard(int file, int rank)
+{
+    return 0 <= file && file < 8 && 0 <= rank && rank < 8;
+}
+
+Bitboard rayAttacks(int square, Bitboard occupied, int delta_file, int delta_rank)
+{
+    Bitboard attacks = 0;
+
+    int file = fileOf(square) + delta_file;
+    int rank = rankOf(square) + delta_rank;
+
+    while (onBoard(file, rank))
+    {
+        Bitboard bit = squareBit(makeSquare(file, rank));
+        attacks |= bit;
+
+        if (occupied & bit)
+        {
+            break;
+        }
+
+        file += delta_file;
+        rank += delta_rank;
+    }
+
+    return attacks;
+}
+
+static Bitboard slowRookAttacks(int square, Bitboard occupied)
+{
+    return rayAttacks(square, occupied, 1, 0) | rayAttacks(square, occupied, -1, 0) |
+            rayAttacks(square, occupied, 0, 1) | rayAttacks(square, occupied, 0, -1);
+}
+
+static Bitboard slowBishopAttacks(int square, Bitboard occupied)
+{
+    return rayAttacks(square, occupied, 1, 1) | rayAttacks(square, occupied, 1, -1) |
+            rayAttacks(square, occupied, -1, 1) | rayAttacks(square, occupied, -1, -1);
+}
+
+// PEXT is microcoded and slower than a multiply on AMD before Zen 3
+static bool pextIsFast()
+{
+#if defined(__x86_64__) && defined(__BMI2__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("bmi2") && !__builtin_cpu_is("znver1") && !__builtin_cpu_is("znver2");
+#else
+    return false;
+#endif
+}
+
+static Bitboard randomSparse(std::uint64_t& state)
+{
+    Bitboard r = 0;
+
+    for (int i = 0; i < 3; ++i)
+    {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        r = (i == 0) ? state * 2685821657736338717ULL : r & (state * 2685821657736338717ULL);
+    }
+
+    return r;
+}
+
+// the board edges never block a ray, so they are left out of the mask
+static Bitboard relevantMask(int square, Bitboard (*attacks)(int, Bitboard))
+{
+    const Bitboard rank_1 = 0xFFULL;
+    const Bitboard rank_8 = rank_1 << 56;
+    const Bitboard file_a = 0x0101010101010101ULL;
+    const Bitboard file_h = file_a << 7;
+
+    Bitboard edges = ((rank_1 | rank_8) & ~(rank_1 << (8 * rankOf(square)))) |
+            ((file_a | file_h) & ~(file_a << fileOf(square)));
+
+    return attacks(square, 0) & ~edges;
+}
+
+static void initMagics(Magic* magics, Bitboard* table, Bitboard (*attacks)(int, Bitboard))
+{
+    Bitboard occupancy[4096];
+    Bitboard reference[4096];
+    int epoch[4096] = {};
+    int attempt = 0;
+    // per-rank seeds known to reach a working magic for every square after few tries
+    static const std::uint64_t seeds[8] = {728, 10316, 55013, 32803, 12281, 15100, 16645, 255};
+    std::uint64_t state = 0;
+
+    for (int square = 0; square < SQUARE_NB; ++square)
+    {
+        Magic& m = magics[square];
+        m.mask = relevantMask(square, attacks);
+        m.shift = 64 - popCount(m.mask);
+        m.attacks = (square == 0) ? table : magics[square - 1].attacks + (1 << (64 - magics[square - 1].shift));
+
+        // every subset of the mask (carry-rippler) with the attacks it leads to
+        int size = 0;
+        Bitboard subset = 0;
+        do
+        {
+            occupancy[size] = subset;
+            reference[size] = attacks(square, subset);
+
+            if (use_pext)
+            {
+                m.attacks[magicIndex(m, subset)] = reference[size];
+            }
+
+            ++size;
+            subset = (subset - m.mask) & m.mask;
+        } while (subset);
+
+        if (use_pext)
+        {
+            continue;
+        }
+
+        // try sparse random numbers until one maps all subsets without a harmful collision
+        state = seeds[rankOf(square)];
+        for (int i = 0; i < size; )
+        {
+            do
+            {
+                m.magic = randomSparse(state);
+            } while (popCount((m.magic * m.mask) >> 56) < 6);
+
+            ++attempt;
+            for (i = 0; i < size; ++i)
+            {
+                unsigned index = magicIndex(m, occupancy[i]);
+
+                if (epoch[index] < attempt)
+                {
+                    epoch[index] = attempt;
+                    m.attacks[index] = reference[i];
+                }
+
+                else if (m.attacks[index] != reference[i])
+                {
+                    break;
+                }
+            }
+        }
+    }
+}
+
+void initBitboards()
+{
+    use_pext = pextIsFast();
+
+    initMagics(rook_magics, rook_table, slowRookAttacks);
+    initMagics(bishop_magics, bishop_table, slowBishopAttacks);
+}
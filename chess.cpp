@@ -1,16 +1,129 @@
 #include "chess.h"
+#include "game.h"
+#include "polyglot.h"
+#include "search.h"
+#include "uci.h"
 #include <cstdlib>
+#include <iostream>
+#include <string>
 
-int main()
+// engine moves in the labels printBoard uses (rows counted from black's side)
+static std::string boardCoordinates(const Move& move)
 {
+    return {static_cast<char>('a' + fileOf(move.from)), static_cast<char>('8' - rankOf(move.from)),
+        static_cast<char>('a' + fileOf(move.to)), static_cast<char>('8' - rankOf(move.to))};
+}
+
+static const char* resultMessage(GameResult result, FigureColor to_move)
+{
+    switch (result)
+    {
+        case GameResult::Checkmate:
+            return to_move == FigureColor::White ? "Checkmate, black wins" : "Checkmate, white wins";
+        case GameResult::Stalemate:
+            return "Stalemate, draw";
+        case GameResult::InsufficientMaterial:
+            return "Insufficient material, draw";
+        case GameResult::FiftyMoves:
+            return "Fifty moves without a capture or pawn move, draw";
+        case GameResult::Repetition:
+            return "Threefold repetition, draw";
+        default:
+            return "";
+    }
+}
+
+// "chess" for two players, "chess white [depth] [weights] [book]" or "chess black [depth] [weights] [book]"
+// to play that side against the engine, which evaluates with the network in the weights file when one is
+// given ("-" for none) and plays from the Polyglot book while it can; "chess uci" speaks UCI on
+// stdin/stdout with no board drawn
+int main(int argc, char* argv[])
+{
+    if (argc > 1 && std::string(argv[1]) == "uci")
+    {
+        return Uci().loop();
+    }
+
+    bool engine_plays[2] = {false, false};
+    SearchLimits limits;
+    limits.depth = 6;
+    Network network;
+    PolyglotBook book;
+
+    if (argc > 1)
+    {
+        std::string side = argv[1];
+        engine_plays[0] = side == "black";
+        engine_plays[1] = side == "white";
+
+        if (argc > 2)
+        {
+            limits.depth = std::atoi(argv[2]);
+        }
+
+        if (argc > 3 && std::string(argv[3]) != "-" && !network.load(argv[3]))
+        {
+            std::cerr << "cannot load " << argv[3] << std::endl;
+            return 1;
+        }
+
+        if (argc > 4 && !book.open(argv[4]))
+        {
+            std::cerr << "cannot load " << argv[4] << std::endl;
+            return 1;
+        }
+    }
+
+    TranspositionTable tt(64);
+    std::string last_engine_move;
+
     std::system("clear");
-    Chess game;
-    while (true)
+    Game game;
+    if (network.isLoaded())
+    {
+        game.setNetwork(&network);
+    }
+
+    GameResult result = GameResult::Ongoing;
+    while (result == GameResult::Ongoing)
     {
-        game.printBoard();
-        game.makeMove();
+        if (!last_engine_move.empty())
+        {
+            std::cout << "Engine played " << last_engine_move << "\n\n";
+        }
+
+        game.position().printBoard();
+
+        if (engine_plays[static_cast<int>(game.position().getPlayerType())])
+        {
+            Move move = book.pick(game.position());
+            if (move == NO_MOVE)
+            {
+                move = Search(game.position(), tt).run(limits).best_move;
+            }
+
+            game.playMove(move);
+            last_engine_move = boardCoordinates(move);
+        }
+
+        else
+        {
+            // against the engine a takeback goes back to the player's previous move
+            game.makeMove(engine_plays[0] || engine_plays[1] ? 2 : 1);
+            last_engine_move.clear();
+        }
+
         std::system("clear");
+        result = game.position().checkGameOver();
     }
 
+    if (!last_engine_move.empty())
+    {
+        std::cout << "Engine played " << last_engine_move << "\n\n";
+    }
+
+    game.position().printBoard();
+    std::cout << resultMessage(result, game.position().getPlayerType()) << std::endl;
+
     return 0;
 }
@@ -1,9 +1,14 @@
 #ifndef CHESS_H
 #define CHESS_H
 
-#include <vector>
 #include <string>
+#include <string_view>
 #include <initializer_list>
+#include <cstdint>
+#include "bitboard.h"
+#include "evaluate.h"
+#include "nnue.h"
+#include "pawns.h"
 
 struct Point {
     int x;
@@ -16,198 +21,257 @@ struct Point {
     
     bool operator!=(const Point& p2) const
     {
-        return x != p2.x && y != p2.y;
+        return x != p2.x || y != p2.y;
     }
 };
 
-enum class FigureColor {
+enum class FigureColor : std::uint8_t {
     White = 0, Black = 1
 };
 
-enum class FigureType {
+enum class FigureType : std::uint8_t {
     Pawn, Knight, Bishop, Rook, Queen, King
 };
 
-class Chess;
-
+// colour and type packed in one byte: bit 3 is the colour, bits 0-2 the type plus one,
+// so a default constructed Piece is an empty square
 class Piece {
     private:
-        FigureType m_type;
-        FigureColor m_color; // 0 white, 1 black
-        int m_value; // value of piece Queen 9
+        std::uint8_t m_code;
 
-        virtual bool checkMove(Chess* const game, const Point& start, const Point& end) const = 0;
-    
     public:
-        Piece(FigureType type, FigureColor color, int value);
-        virtual ~Piece() = default;
+        constexpr Piece() : m_code(0) {}
+        constexpr Piece(FigureColor color, FigureType type) :
+            m_code(static_cast<std::uint8_t>((static_cast<int>(color) << 3) | (static_cast<int>(type) + 1))) {}
+
+        constexpr explicit operator bool() const { return m_code != 0; }
 
-        virtual void printPiece() const = 0;
+        constexpr FigureColor getColor() const { return static_cast<FigureColor>(m_code >> 3); }
+        constexpr FigureType getType() const { return static_cast<FigureType>((m_code & 7) - 1); }
+
+        constexpr bool operator==(const Piece& p2) const { return m_code == p2.m_code; }
+        constexpr bool operator!=(const Piece& p2) const { return m_code != p2.m_code; }
 
         char getFigureColor() const;
         char getFigureType() const;
 
-        friend class Chess;
+        void printPiece() const;
 };
 
-class Pawn : public Piece {
-    private:
-        bool m_double_move;
-
-        bool checkMove(Chess* const game, const Point& start, const Point& end) const override; 
+static_assert(sizeof(Piece) == 1, "a piece is one byte");
 
-    public:
-        Pawn(FigureColor color);
-        ~Pawn() override = default;
-
-        void setDoubleMove(bool val);
-        bool getDoubleMove() const;
-
-        void printPiece() const override;
+enum class MoveType : std::uint8_t {
+    None, Passant, Promote, CastleLeft, CastleRight
 };
 
-class Knight : public Piece {
-    private:
-        bool checkMove(Chess* const game, const Point& start, const Point& end) const override;
+struct Move {
+    std::uint8_t from; // bitboard squares, a1 = 0
+    std::uint8_t to;
+    MoveType type;
+    FigureType promote; // only meaningful for MoveType::Promote
 
-    public:
-        Knight(FigureColor color);
-        ~Knight() override = default;
+    bool operator==(const Move& m2) const
+    {
+        return from == m2.from && to == m2.to && type == m2.type && promote == m2.promote;
+    }
+
+    bool operator!=(const Move& m2) const
+    {
+        return !(*this == m2);
+    }
 
-        void printPiece() const override;
+    // 16 bits for hash tables and game files: from (6), to (6), flag (4)
+    std::uint16_t pack() const;
+    static Move unpack(std::uint16_t data);
 };
 
-class Bishop : public Piece {
-    private:
-        bool checkMove(Chess* const game, const Point& start, const Point& end) const override;
+constexpr Move NO_MOVE = {0, 0, MoveType::None, FigureType::Queen}; // packs to 0
 
-    public:
-        Bishop(FigureColor color);
-        ~Bishop() override = default;
-       
-        void printPiece() const override;
-};
+constexpr int MAX_MOVES = 256; // no legal position has more than 218
 
-class Rook : public Piece {
+// fixed-capacity move list meant to live on the stack
+class MoveList {
     private:
-        bool m_castle_available;
-        bool checkMove(Chess* const game, const Point& start, const Point& end) const override;
+        Move m_moves[MAX_MOVES];
+        int m_size;
 
     public:
-        Rook(FigureColor color, bool castle_available);
-        ~Rook() override = default;
-
-        void setCastleAvailable(bool value);
-        bool getCastleAvailable() const; 
-        
-        void printPiece() const override;
-};
+        MoveList() : m_size(0) {}
 
-class Queen : public Piece {
-    private:
-        bool checkMove(Chess* const game, const Point& start, const Point& end) const override;
+        void push(const Move& move) { m_moves[m_size++] = move; }
+        void clear() { m_size = 0; }
 
-    public:
-        Queen(FigureColor color);
-        ~Queen() override = default;
+        int size() const { return m_size; }
+        Move& operator[](int i) { return m_moves[i]; }
+        const Move& operator[](int i) const { return m_moves[i]; }
 
-        void printPiece() const override;
+        Move* begin() { return m_moves; }
+        Move* end() { return m_moves + m_size; }
+        const Move* begin() const { return m_moves; }
+        const Move* end() const { return m_moves + m_size; }
 };
 
-class King : public Piece {
-    private:
-        bool m_castle_available;
+// what a call to generateMoves produces; promotions go with the captures
+enum class GenType : std::uint8_t {
+    All, Captures, Quiets
+};
 
-        bool checkMove(Chess* const game, const Point& start, const Point& end) const override;
-        
-    public: 
-        King(FigureColor color);
-        ~King() override = default;
+enum CastleRight {
+    WhiteKingSide = 1, WhiteQueenSide = 2, BlackKingSide = 4, BlackQueenSide = 8,
+    AllCastleRights = 15
+};
 
-        void setCastleAvailable(bool value);
-        bool getCastleAvailable() const; 
+constexpr int NO_PIECE = -1;
 
-        void printPiece() const override;
+// everything doMove overwrites, so undoMove restores it without recomputing anything
+struct UndoInfo {
+    std::uint64_t hash;
+    Move move;
+    std::int8_t captured; // FigureType of the eaten piece or NO_PIECE
+    std::uint8_t castle_rights;
+    std::int8_t en_passant;
+    std::uint16_t halfmove_clock;
 };
 
-class Player {
-    private:
-        Point m_last_move_start;
-        Point m_last_move_end;
-        Point m_king_position;
+constexpr const char* START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
 
-    public:
-        Player(const Point& king_position);
-        ~Player() = default;
-
-        void setMove(const Point& start, const Point& end);
-        Point getMoveStart() const;
-        Point getMoveEnd() const;
+// undo records a position keeps: a search as deep as MAX_PLY (128) on top of the
+// fifty-move window repetitions look back through; older ones are overwritten,
+// and Game replays from the start to take back past them
+constexpr int UNDO_PLIES = 256;
+static_assert((UNDO_PLIES & (UNDO_PLIES - 1)) == 0, "the undo records are a ring indexed by ply");
 
-        void setKingPosition(const Point& pos);
-        Point getKingPosition() const;
+enum class GameResult : std::uint8_t {
+    Ongoing, Checkmate, Stalemate, InsufficientMaterial, FiftyMoves, Repetition
 };
 
-enum class MoveType {
-    None, Passant, Promote, Rook, King, CastleLeft, CastleRight
+// 12 piece bitboards plus occupancy, 120 bytes, trivially copyable
+struct Board {
+    Bitboard pieces[2][6]; // [FigureColor][FigureType]
+    Bitboard occupancy[2]; // [FigureColor]
+    Bitboard all;
 };
 
 class Chess {
     private:
         FigureColor m_player_turn;
-        Player m_white;
-        Player m_black;
- 
-        mutable MoveType m_current_move_type;
-
-        std::vector<std::vector<Piece*>> m_board;
 
-        void initializeRow(int row_number, FigureColor color, bool mode);
+        Board m_board;
+        int m_castle_rights;
+        int m_en_passant; // square a pawn may capture onto, NO_SQUARE if none
+        int m_halfmove_clock;
+        int m_start_ply; // plies before the position the game was set up from, by the FEN's move number
+        std::uint64_t m_hash; // zobrist key, kept up to date by doMove/undoMove
+        std::uint64_t m_pawn_key; // zobrist key of the pawns alone, kept by putPiece/removePiece/shiftPiece
+        Score m_psq; // material and piece-square sum, white minus black, kept by putPiece/removePiece
+        int m_phase; // sum of phase_weight over the pieces on the board
+
+        const Network* m_network; // evaluates instead of the piece-square tables when set
+        Accumulator m_accumulator; // kept by putPiece/removePiece/shiftPiece while m_network is set
+
+        // the latest moves played and the hash before each, at ply modulo UNDO_PLIES;
+        // a fixed ring, so copying a position for a search thread allocates nothing
+        UndoInfo m_undo[UNDO_PLIES];
+        int m_undo_size; // plies played since the FEN
+        int m_undo_first; // the oldest ply still in m_undo
 
         static bool checkInput(const std::string& move);
         static void initializeCoordinates(Point& start, Point& end, const std::string& move);
 
         static bool borderCheck(int n);
 
-        bool checkStart(const Point& start) const;
-        bool checkEnd(const Point& end) const;
+        static int toSquare(const Point& coord);
+        static Point toPoint(int square);
 
-        Point direction(int delta_x, int delta_y) const; 
+        Bitboard attackersTo(int square, Bitboard occupied) const;
+        bool isAttacked(int square, int by_color) const;
+        int kingSquare(int color) const;
+        Bitboard checkers() const;
+        Bitboard pinnedPieces(int color) const;
 
-        Piece* pieceInLine(Point start, Point end, const Point& delta) const;
+        void putPiece(int square, int color, int type);
+        void removePiece(int square, int color, int type);
+        void shiftPiece(int from, int to, int color, int type);
 
-        Piece* copyPiece(const Point& coord) const;
+        std::uint64_t computeHash() const;
+        std::uint64_t computePawnKey() const;
+        Score computePsq() const;
 
-        Piece* movePiece(const Point& start, const Point& end, Piece*& piece_copy);
-        void reMovePiece(const Point& start, const Point& end, Piece* moved, Piece* eaten);
+        void evaluatePawns(PawnEntry& entry) const;
+        int kingShelter(int color) const;
+        Score pawnPieceTerms(const PawnEntry& pawns, int color) const;
 
-        void changeKingCoordinates(const Point& coord);
+        Bitboard genTargets(GenType gen) const;
+        void generatePieceMoves(MoveList& moves, int type, Bitboard targets, Bitboard pinned) const;
+        void generatePawnMoves(MoveList& moves, GenType gen, Bitboard targets, Bitboard pinned) const;
+        void generateKingMoves(MoveList& moves, Bitboard targets) const;
+        void generateCastles(MoveList& moves) const;
+        bool isLegalEnPassant(int from) const;
+
+        void changeTurn();
+        void pushUndo(const UndoInfo& undo);
+        UndoInfo popUndo();
+        int countRepetitions(int limit, int within) const;
 
         bool isCheck(const Point& coord) const;
-        bool checkGameOver() const;
 
     public:
         Chess();
-        ~Chess();
+        ~Chess() = default;
 
-        void makeMove();
+        std::string readMove() const; // from stdin until legal, in coordinate notation, or "undo"/"redo"
 
-        void setPiece(const Point& coord, Piece* const piece);
-        Piece* getPiece(const Point& coord) const;
+        void generateMoves(MoveList& moves, GenType gen = GenType::All) const;
+        bool isLegalMove(const Move& move) const;
+        bool hasLegalMove() const;
 
-        void setMoveType(MoveType type);
+        bool isRepetition(int count) const;
+        bool isDraw(int ply) const; // for search, ply = moves played since the root
+        bool isInsufficientMaterial() const;
+        GameResult checkGameOver() const;
 
-        FigureColor getPlayerType() const;
-        Player& getPlayer(FigureColor color);
+        void doMove(const Move& move);
+        void undoMove();
+        void doNullMove();
+        void undoNullMove();
 
-        bool checkMoveLinear(const Point& start, const Point& end) const;
-        bool checkMoveDiagonal(const Point& start, const Point& end) const;
+        // no console I/O below: promotions carry their piece in the move or the trailing letter
+        Move parseMove(const std::string& text) const; // coordinate notation, NO_MOVE unless legal
+        Move parseSAN(std::string_view san) const; // algebraic notation, NO_MOVE unless legal and unambiguous
+        bool applyMove(const Move& move); // false, changing nothing, when illegal
+        bool tryMove(const std::string& text); // parseMove then doMove
+        int gamePly() const;
+        int undoPlies() const; // moves undoMove can still take back, at most UNDO_PLIES
 
-        bool checkCastle(const Point& start, const Point& end) const;
+        std::uint64_t getHash() const;
+        std::uint64_t getPawnKey() const;
+        std::uint64_t polyglotKey() const; // the key of Polyglot opening books
+        Move lastMove() const; // NO_MOVE at the start or after a null move
 
-        void printBoard() const;
+        int pieceTypeOn(int square) const;
+
+        bool inCheck() const;
+        bool isCapture(const Move& move) const;
+        int see(const Move& move) const; // material won by the exchange the move starts, centipawns
+        bool hasNonPawnMaterial() const;
+
+        int evaluate(PawnTable* pawn_table = nullptr) const; // pawn structure cached when a table is given
+        void setNetwork(const Network* network); // nullptr goes back to the piece-square tables
+
+        bool fromFEN(const std::string& fen); // false, changing nothing, when malformed
+        std::string toFEN() const;
+
+        std::uint64_t perft(int depth);
+        std::uint64_t divide(int depth);
 
-        friend class Piece;
+        static std::string moveToString(const Move& move);
+
+        void setPiece(const Point& coord, Piece piece);
+        Piece getPiece(const Point& coord) const;
+
+        FigureColor getPlayerType() const;
+
+        void printBoard() const;
 };
 
 #endif
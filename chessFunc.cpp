@@ -1,911 +1,1206 @@
+#include <algorithm>
 #include <iostream>
+#include <cctype>
+#include <charconv>
+#include <string_view>
 #include <cmath>
+#include <cstdlib>
+#include <cassert>
 #include "chess.h"
+#include "zobrist.h"
 
-Chess::Chess() : m_player_turn(FigureColor::White),
-    m_white({7, 4}), m_black({0, 4}), 
-    m_board(8, std::vector<Piece*>(8, nullptr)), m_current_move_type(MoveType::None)
+// castle rights that survive a move touching the square (a1, e1, h1, a8, e8, h8 clear theirs)
+static int castleMask(int square)
 {
-    initializeRow(0, FigureColor::Black, 0);
-    initializeRow(1, FigureColor::Black, 1);
-    initializeRow(6, FigureColor::White, 1);
-    initializeRow(7, FigureColor::White, 0);
-}
+    switch (square) {
+        case 0:
+            return AllCastleRights & ~WhiteQueenSide;
 
-void Chess::initializeRow(int row_number, FigureColor color, bool mode)
-{
-    if (mode)
-    {
-        for (int i = 0; i < 8; ++i)
-        {
-            m_board[row_number][i] = new Pawn(color);
-        }
-    }
+        case 4:
+            return AllCastleRights & ~(WhiteKingSide | WhiteQueenSide);
 
-    else
-    {
-        m_board[row_number][0] = new Rook(color, true);
-        m_board[row_number][1] = new Knight(color);
-        m_board[row_number][2] = new Bishop(color);
-        m_board[row_number][3] = new Queen(color);
-        m_board[row_number][4] = new King(color);
-        m_board[row_number][5] = new Bishop(color);
-        m_board[row_number][6] = new Knight(color);
-        m_board[row_number][7] = new Rook(color, true);
-    }
-}
+        case 7:
+            return AllCastleRights & ~WhiteKingSide;
 
-Chess::~Chess()
-{
-    for (int i = 0; i < 8; ++i)
-    {
-        for (int j = 0; j < 8; ++j)
-        {
-            if (m_board[i][j])
-            {
-                delete m_board[i][j];
-                m_board[i][j] = nullptr;
-            }
-        }
-    }
-}
+        case 56:
+            return AllCastleRights & ~BlackQueenSide;
 
-bool Chess::checkInput(const std::string& move)
-{ 
-    return move.size() == 4 && 
-            borderCheck(move[0] - 'a') && borderCheck(move[1] - '1') && 
-            borderCheck(move[2] - 'a') && borderCheck(move[3] - '1');
-}
+        case 60:
+            return AllCastleRights & ~(BlackKingSide | BlackQueenSide);
 
-void Chess::initializeCoordinates(Point& start, Point& end, const std::string& move)
-{
-    start.x = move[1] - '1';
-    start.y = move[0] - 'a';
-    end.x = move[3] - '1';
-    end.y = move[2] - 'a';
-}
+        case 63:
+            return AllCastleRights & ~BlackKingSide;
+    }
 
-void Chess::setPiece(const Point& coord, Piece* const piece)
-{ 
-    m_board[coord.x][coord.y] = piece;
+    return AllCastleRights;
 }
 
-Piece* Chess::getPiece(const Point& coord) const
+Chess::Chess() : m_player_turn(FigureColor::White), m_board(), m_castle_rights(AllCastleRights),
+    m_en_passant(NO_SQUARE), m_halfmove_clock(0), m_start_ply(0), m_hash(0), m_pawn_key(0), m_psq(), m_phase(0),
+    m_network(nullptr), m_accumulator(), m_undo_size(0), m_undo_first(0)
 {
-    return m_board[coord.x][coord.y];
-}
+    static const bool initialized = (initBitboards(), true);
+    (void)initialized;
 
-void Chess::setMoveType(MoveType type)
-{
-    m_current_move_type = type;
+    fromFEN(START_FEN);
 }
 
-bool Chess::borderCheck(int coord)
-{ 
-    return 0 <= coord && coord < 8; 
-};
-
-bool Chess::checkStart(const Point& start) const
+// pieces of either color attacking the square, sliders seen through occupied
+static Bitboard boardAttackers(const Board& board, int square, Bitboard occupied)
 {
-    Piece* piece = getPiece(start);
-    return piece && piece->m_color == m_player_turn;
-}
+    const Bitboard (&white)[6] = board.pieces[0];
+    const Bitboard (&black)[6] = board.pieces[1];
 
-bool Chess::checkEnd(const Point& end) const
-{
-    Piece* piece = getPiece(end);
-    return (!piece) || piece->m_color != m_player_turn;
+    Bitboard rooks_queens = white[3] | white[4] | black[3] | black[4];
+    Bitboard bishops_queens = white[2] | white[4] | black[2] | black[4];
+
+    return (pawnAttacks(0, square) & black[0]) | (pawnAttacks(1, square) & white[0]) |
+            (knightAttacks(square) & (white[1] | black[1])) |
+            (kingAttacks(square) & (white[5] | black[5])) |
+            (rookAttacks(square, occupied) & rooks_queens) |
+            (bishopAttacks(square, occupied) & bishops_queens);
 }
 
-Point Chess::direction(int delta_x, int delta_y) const
+// the space separated field starting at or after pos, empty past the end
+static std::string_view nextField(const std::string& text, std::size_t& pos)
 {
-    int dl_x = 0;
-    int dl_y = 0;
-
-    if (delta_x > 0)
-    {
-        dl_x = 1;
-    }
-
-    else if (delta_x < 0)
-    {
-        dl_x = -1;
-    }
-
-    if (delta_y > 0)
+    std::size_t start = text.find_first_not_of(' ', pos);
+    if (start == std::string::npos)
     {
-        dl_y = 1;
+        pos = text.size();
+        return {};
     }
 
-    else if (delta_y < 0)
+    std::size_t end = text.find(' ', start);
+    if (end == std::string::npos)
     {
-        dl_y = -1;
+        end = text.size();
     }
 
-    return {dl_x, dl_y};
+    pos = end;
+    return std::string_view(text).substr(start, end - start);
 }
 
-bool Chess::checkMoveLinear(const Point& start, const Point& end) const
-{
-    int delta_x = end.x - start.x;
-    int delta_y = end.y - start.y;
-
-    Point dir = direction(delta_x, delta_y);
+constexpr int MAX_FULLMOVE = 1000000; // keeps the ply counts far from overflowing
 
-    if (dir.x == 0 || dir.y == 0)
+// a FEN clock: digits only, at most max, value left alone when the field is left out
+static bool parseCount(std::string_view field, int max, int& value)
+{
+    if (field.empty())
     {
-        return !pieceInLine(start, end, dir);
+        return true;
     }
 
-    return false;
-}
-
-bool Chess::checkMoveDiagonal(const Point& start, const Point& end) const
-{
-    int delta_x = end.x - start.x;
-    int delta_y = end.y - start.y;
+    int parsed = 0;
+    auto [end, error] = std::from_chars(field.data(), field.data() + field.size(), parsed);
 
-    if (abs(delta_x) == abs(delta_y))
+    if (error != std::errc() || end != field.data() + field.size() || parsed < 0 || parsed > max)
     {
-        Point dir = direction(delta_x, delta_y);
-        return !pieceInLine(start, end, dir);
+        return false;
     }
 
-    return false;
+    value = parsed;
+    return true;
 }
 
-Piece* Chess::pieceInLine(Point start, Point end, const Point& delta) const
+// Sets up the position from Forsyth-Edwards Notation, the two clocks may be left
+// out. The game history is dropped. Nothing changes when the FEN is malformed or
+// describes a position the move generator cannot play from: not one king a side,
+// pawns on the back ranks, the side that just moved in check. Castle rights
+// without their king and rook at home and impossible en passant squares are dropped.
+bool Chess::fromFEN(const std::string& fen)
 {
-    while (borderCheck(start.x + delta.x) && borderCheck(start.y + delta.y) && start != end)
+    std::size_t pos = 0;
+    std::string_view placement = nextField(fen, pos);
+    std::string_view turn = nextField(fen, pos);
+    std::string_view castle = nextField(fen, pos);
+    std::string_view en_passant = nextField(fen, pos);
+    std::string_view halfmove_field = nextField(fen, pos);
+    std::string_view fullmove_field = nextField(fen, pos);
+
+    if (placement.empty() || turn.empty())
     {
-        start.x += delta.x;
-        start.y += delta.y;
-
-        Piece* piece = getPiece(start);
-        if (piece)
-        {
-            return piece;
-        }
+        return false;
     }
 
-    return nullptr;
-}
-
-bool Chess::isCheck(const Point& coord) const
-{
-    int horizontal_x[] = {-1, 1, 0, 0};
-    int horizontal_y[] = {0, 0, -1, 1};
-    
-    int diagonal_x[] = {-1, -1, 1, 1};
-    int diagonal_y[] = {-1, 1, -1, 1};
-
-    char color = 'W';
-
-    if (getPlayerType() == FigureColor::Black)
+    // the halfmove clock has to fit the undo records
+    int halfmove_clock = 0;
+    int fullmove = 1;
+    if (!parseCount(halfmove_field, 0xFFFF, halfmove_clock) || !parseCount(fullmove_field, MAX_FULLMOVE, fullmove))
     {
-        color = 'B';
+        return false;
     }
 
-    for (int i = 0; i < 4; ++i)
-    {
-        const Point out_board = {-1, -1};
-        Point dir = {horizontal_x[i], horizontal_y[i]};
-        Piece* piece = pieceInLine(coord, out_board, dir);
+    // parsed into a bare board first, so a bad FEN leaves this position alone;
+    // exactly 8 ranks of 8 files, no pawn on the first or last rank
+    Board board = Board();
+    int rank = 7;
+    int file = 0;
 
-        if (piece)
+    for (char c : placement)
+    {
+        if (c == '/')
         {
-            char type = piece->getFigureType();
-            if (piece->getFigureColor() != color && (type == 'R' || type == 'Q'))
+            if (file != 8 || rank == 0)
             {
                 return false;
             }
-        }
 
-        Point king = {coord.x + horizontal_x[i], coord.y + horizontal_y[i]};
-        
-        if (borderCheck(king.x) && borderCheck(king.y))
-        {
-            Piece* piece = getPiece(king);
-            if (piece && piece->getFigureType() == 'K')
-            {
-                return false;
-            }
+            --rank;
+            file = 0;
+            continue;
         }
 
-        dir = {diagonal_x[i], diagonal_y[i]};
-        piece = pieceInLine(coord, out_board, dir);
-        
-        if (piece)
+        if ('1' <= c && c <= '8')
         {
-            char type = piece->getFigureType();
-            if (piece->getFigureColor() != color && (type == 'B' || type == 'Q'))
+            file += c - '0';
+
+            if (file > 8)
             {
                 return false;
             }
+
+            continue;
         }
 
-        king = {coord.x + diagonal_x[i], coord.y + diagonal_y[i]};
+        std::size_t type = std::string_view("pnbrqk").find(static_cast<char>(std::tolower(c)));
 
-        if (borderCheck(king.x) && borderCheck(king.y))
+        if (type == std::string_view::npos || file == 8 ||
+                (type == static_cast<std::size_t>(FigureType::Pawn) && (rank == 0 || rank == 7)))
         {
-            Piece* piece = getPiece(king);
-            if (piece && piece->getFigureType() == 'K')
-            {
-                return false;
-            }
+            return false;
         }
+
+        int color = std::islower(c) ? 1 : 0;
+        board.pieces[color][type] |= squareBit(makeSquare(file, rank));
+        ++file;
+    }
+
+    if (rank != 0 || file != 8)
+    {
+        return false;
     }
 
-    int knight_x[] = {2, 2, -2, -2, 1, 1, -1, -1};
-    int knight_y[] = {1, -1, 1, -1, 2, -2, 2, -2};
+    if (popCount(board.pieces[0][static_cast<int>(FigureType::King)]) != 1 ||
+            popCount(board.pieces[1][static_cast<int>(FigureType::King)]) != 1 || (turn != "w" && turn != "b"))
+    {
+        return false;
+    }
 
-    for (int i = 0; i < 8; ++i)
+    // the side that just moved cannot have left its king in check
+    int mover = turn == "w" ? 1 : 0;
+    Bitboard occupied = 0;
+    for (int color = 0; color < 2; ++color)
     {
-        Point knight_coord = {coord.x + knight_x[i], coord.y + knight_y[i]};
-        if (borderCheck(knight_coord.x) && borderCheck(knight_coord.y))
+        for (int type = 0; type < 6; ++type)
         {
-            Piece* piece = getPiece(knight_coord);
-            if (piece && piece->getFigureColor() != color && piece->getFigureType() == 'N')
-            {
-                return false;
-            }
+            board.occupancy[color] |= board.pieces[color][type];
         }
-    }
 
-    int pawn_x = 1;
+        occupied |= board.occupancy[color];
+    }
 
-    if (getPlayerType() == FigureColor::White)
+    int mover_king = lsb(board.pieces[mover][static_cast<int>(FigureType::King)]);
+    if (boardAttackers(board, mover_king, occupied) & board.occupancy[1 - mover])
     {
-        pawn_x = -1;
+        return false;
     }
 
-    int pawn_y[] = {-1, 1};
-    for (int i = 0; i < 2; ++i)
+    const Network* network = m_network;
+    m_network = nullptr; // the accumulator is refreshed once at the end instead of per piece
+
+    m_board = Board();
+    m_pawn_key = 0;
+    m_psq = Score();
+    m_phase = 0;
+
+    for (int color = 0; color < 2; ++color)
     {
-        Point pawn_coord = {coord.x - pawn_x, coord.y + pawn_y[i]};
-        if (borderCheck(pawn_coord.x) && borderCheck(pawn_coord.y))
+        for (int type = 0; type < 6; ++type)
         {
-            Piece* piece = getPiece(pawn_coord);
-            if (piece && piece->getFigureColor() != color && piece->getFigureType() == 'P')
+            Bitboard pieces = board.pieces[color][type];
+            while (pieces)
             {
-                return false;
+                putPiece(popLsb(pieces), color, type);
             }
         }
     }
 
-    return true;
-}
-
-Piece* Chess::copyPiece(const Point& coord) const
-{
-    Piece* piece = getPiece(coord);
+    m_player_turn = (turn == "w") ? FigureColor::White : FigureColor::Black;
+    int us = static_cast<int>(m_player_turn);
 
-    switch (piece->getFigureType()) {
-        case 'P':
-            return new Pawn (*dynamic_cast<Pawn*>(piece));
+    m_castle_rights = 0;
+    for (char c : castle)
+    {
+        switch (c)
+        {
+            case 'K':
+                m_castle_rights |= WhiteKingSide;
+                break;
 
-        case 'N':
-            return new Knight (*dynamic_cast<Knight*>(piece));
+            case 'Q':
+                m_castle_rights |= WhiteQueenSide;
+                break;
 
-        case 'B':
-            return new Bishop (*dynamic_cast<Bishop*>(piece));
-    
-        case 'R':
-            return new Rook (*dynamic_cast<Rook*>(piece));
-    
-        case 'Q':
-            return new Queen (*dynamic_cast<Queen*>(piece));
+            case 'k':
+                m_castle_rights |= BlackKingSide;
+                break;
 
-        case 'K':
-            return new King (*dynamic_cast<King*>(piece));
+            case 'q':
+                m_castle_rights |= BlackQueenSide;
+                break;
+        }
     }
 
-    return nullptr;
-}
-
-void Chess::changeKingCoordinates(const Point& coord)
-{
-    if (getPlayerType() == FigureColor::White)
+    // a right only stands while its king and rook are still on their home squares,
+    // castleMask names those squares for every right
+    for (int square : {0, 4, 7, 56, 60, 63})
     {
-        m_white.setKingPosition(coord);   
+        int color = square < 8 ? 0 : 1;
+        int type = static_cast<int>(square % 8 == 4 ? FigureType::King : FigureType::Rook);
+
+        if (!(m_board.pieces[color][type] & squareBit(square)))
+        {
+            m_castle_rights &= castleMask(square);
+        }
     }
 
-    else
+    // kept only when a pawn can actually take, the same rule doMove follows: on the
+    // third rank behind a pawn that has just made a double step over it
+    m_en_passant = NO_SQUARE;
+    if (en_passant.size() == 2 && borderCheck(en_passant[0] - 'a') && en_passant[1] == (us == 0 ? '6' : '3'))
     {
-        m_black.setKingPosition(coord);
+        int square = makeSquare(en_passant[0] - 'a', en_passant[1] - '1');
+        int push = us == 0 ? 8 : -8;
+
+        if ((pawnAttacks(1 - us, square) & m_board.pieces[us][static_cast<int>(FigureType::Pawn)]) &&
+                (m_board.pieces[1 - us][static_cast<int>(FigureType::Pawn)] & squareBit(square - push)) &&
+                !(m_board.all & (squareBit(square) | squareBit(square + push))))
+        {
+            m_en_passant = square;
+        }
     }
+
+    m_halfmove_clock = halfmove_clock;
+    m_start_ply = 2 * (std::max(fullmove, 1) - 1) + us;
+    m_hash = computeHash();
+
+    m_undo_size = 0;
+    m_undo_first = 0;
+
+    setNetwork(network);
+
+    return true;
 }
 
-Piece* Chess::movePiece(const Point& start, const Point& end, Piece*& piece_copy)
+std::string Chess::toFEN() const
 {
-    piece_copy = copyPiece(start);
-    Piece* piece = getPiece(end);
+    std::string fen;
 
-    setPiece(end, getPiece(start));
-    setPiece(start, nullptr);
-
-    switch (m_current_move_type)
+    for (int rank = 7; rank >= 0; --rank)
     {
-        case MoveType::Passant:
+        int empty = 0;
+
+        for (int file = 0; file < 8; ++file)
         {
-            int delta_x = 1;
-            if (getPlayerType() == FigureColor::Black)
+            int square = makeSquare(file, rank);
+            int type = pieceTypeOn(square);
+
+            if (type == NO_PIECE)
             {
-                delta_x = -1;
+                ++empty;
+                continue;
             }
 
-            Point eaten = {end.x + delta_x, end.y};
-            piece = getPiece(eaten);
+            if (empty)
+            {
+                fen += static_cast<char>('0' + empty);
+                empty = 0;
+            }
 
-            setPiece(eaten, nullptr); 
-            break;
+            char c = "pnbrqk"[type];
+            fen += (m_board.occupancy[0] & squareBit(square)) ? static_cast<char>(std::toupper(c)) : c;
         }
-    
-        case MoveType::Rook:
+
+        if (empty)
         {
-            Rook* rook = dynamic_cast<Rook*>(getPiece(end));
-            rook->setCastleAvailable(false);
-            break;
+            fen += static_cast<char>('0' + empty);
         }
 
-        case MoveType::King:
+        if (rank)
         {
-            King* king = dynamic_cast<King*>(getPiece(end));
-            king->setCastleAvailable(false);
-           
-            changeKingCoordinates(end);
+            fen += '/';
+        }
+    }
 
-            break;
+    fen += m_player_turn == FigureColor::White ? " w " : " b ";
+
+    // the CastleRight bits go in KQkq order
+    for (int i = 0; i < 4; ++i)
+    {
+        if (m_castle_rights & (1 << i))
+        {
+            fen += "KQkq"[i];
         }
+    }
 
-        case MoveType::CastleLeft:
-            setPiece({start.x, 3}, getPiece({start.x, 0}));
-            setPiece({start.x, 0}, nullptr);  
-            
-            changeKingCoordinates(end);
-            
-            break;
+    if (!m_castle_rights)
+    {
+        fen += '-';
+    }
 
-        case MoveType::CastleRight:
-            setPiece({start.x, 5}, getPiece({start.x, 7}));
-            setPiece({start.x, 7}, nullptr);  
-            
-            changeKingCoordinates(end);
-            
-            break;
+    fen += ' ';
+    if (m_en_passant != NO_SQUARE)
+    {
+        fen += static_cast<char>('a' + fileOf(m_en_passant));
+        fen += static_cast<char>('1' + rankOf(m_en_passant));
+    }
+
+    else
+    {
+        fen += '-';
     }
 
-    return piece;
+    fen += ' ' + std::to_string(m_halfmove_clock) + ' ' + std::to_string((m_start_ply + gamePly()) / 2 + 1);
+
+    return fen;
 }
 
-void Chess::reMovePiece(const Point& start, const Point& end, Piece* moved, Piece* eaten)
+std::uint16_t Move::pack() const
 {
-    delete getPiece(end);
-    setPiece(start, moved);
+    int flag = 0;
 
-    switch (m_current_move_type)
+    switch (type)
     {
         case MoveType::Passant:
-        {
-            Point pt = start;
-            if (getPlayerType() == FigureColor::White)
-            {
-                --pt.x;
-            }
-            
-            else
-            {
-                ++pt.x;
-            }
-        
-            setPiece(pt, eaten);
+            flag = 1;
             break;
-        }
 
         case MoveType::CastleLeft:
-        {    
-            setPiece({start.x, 0}, getPiece({start.x, start.y + 1}));
-            setPiece({start.x, start.y + 1}, nullptr);  
-            
-            Rook* rook = dynamic_cast<Rook*>(getPiece({start.x, 0}));
-            King* king = dynamic_cast<King*>(getPiece(start));
-
-            rook->setCastleAvailable(true);
-            king->setCastleAvailable(true);
-
-            changeKingCoordinates(start);
-
+            flag = 2;
             break;
-        }
 
         case MoveType::CastleRight:
-        {
-            setPiece({start.x, 7}, getPiece({start.x, start.y - 1}));
-            setPiece({start.x, start.y - 1}, nullptr);
-
-            Rook* rook = dynamic_cast<Rook*>(getPiece({start.x, 7}));
-            King* king = dynamic_cast<King*>(getPiece(start));
-
-            rook->setCastleAvailable(true);
-            king->setCastleAvailable(true);
-            
-            changeKingCoordinates(start);
-        
+            flag = 3;
             break;
-        }
 
-        case MoveType::King:
-            changeKingCoordinates(start);
+        case MoveType::Promote:
+            flag = 3 + static_cast<int>(promote); // Knight 4 ... Queen 7
+            break;
 
         default:
-            setPiece(end, eaten);
+            break;
     }
-}
-
-void Chess::makeMove() {
-    Point start;
-    Point end;
-    while (true)
-    {
-        if (m_player_turn == FigureColor::White)
-        {
-            std::cout << "White's turn: ";
-        }
 
-        else
-        {
-            std::cout << "Black's turn: ";
-        }
+    return static_cast<std::uint16_t>(from | (to << 6) | (flag << 12));
+}
 
-        std::string move;
-        std::getline(std::cin, move);
+Move Move::unpack(std::uint16_t data)
+{
+    static const MoveType types[] = {MoveType::None, MoveType::Passant, MoveType::CastleLeft, MoveType::CastleRight};
 
-        std::cout << std::endl;
+    int flag = data >> 12;
+    if (flag > 7)
+    {
+        return NO_MOVE; // no move packs to these
+    }
 
-        if (checkInput(move))
-        {
-            initializeCoordinates(start, end, move);       
-            if (checkStart(start) && checkEnd(end) && 
-                getPiece(start)->checkMove(this, start, end))
-            {
-                // if eating, update score
-                Piece* moved;
-                Piece* eaten = movePiece(start, end, moved);
-
-                Point king_pos;
-
-                if (getPlayerType() == FigureColor::White)
-                {
-                    king_pos = m_white.getKingPosition();
-                }
-
-                else
-                {
-                    king_pos = m_black.getKingPosition();
-                }
-
-                if (isCheck(king_pos))
-                {
-                    getPlayer(m_player_turn).setMove(start, end);
-                    
-                    if (m_current_move_type == MoveType::Promote)
-                    {
-                        delete getPiece(end);
-
-                        std::cout << "Enter the Promoted piece type: Knight(N), Bishop(B), Rook(R), Queen(Q): ";
-
-                        FigureColor color = getPlayerType();
-                        
-                        while(true)
-                        {
-                            char figure_type;
-                            
-                            std::cin >> figure_type;
-                            
-                            bool check = false;
-                            switch (figure_type)
-                            {
-                                case 'N':
-                                    setPiece(end, new Knight(color));            
-                                    check = true;
-                                    break;
-                        
-                                case 'B':
-                                    setPiece(end, new Bishop(color));            
-                                    check = true;
-                                    break;
-                        
-                                case 'R':
-                                    setPiece(end, new Rook(color, false));
-                                    check = true;
-                                    break;
-                        
-                                case 'Q':
-                                    setPiece(end, new Queen(color));            
-                                    check = true;
-                                    break;
-                            }
-                            
-                            if (check)
-                            {
-                                break;    
-                            }
-                        }
-                    }
-
-                    m_current_move_type = MoveType::None;
-                    
-                    delete moved;
-
-                    if (eaten)
-                    {
-                        delete eaten;
-                    }
-                
-                    break;
-                }
-
-                reMovePiece(start, end, moved, eaten);
-            }
+    Move move = {static_cast<std::uint8_t>(data & 63), static_cast<std::uint8_t>((data >> 6) & 63), 
+        MoveType::None, FigureType::Queen};
 
-            m_current_move_type = MoveType::None;
-        }
+    if (flag >= 4)
+    {
+        move.type = MoveType::Promote;
+        move.promote = static_cast<FigureType>(flag - 3);
     }
 
-    if (m_player_turn == FigureColor::White)
+    else
     {
-        m_player_turn = FigureColor::Black;
+        move.type = types[flag];
     }
 
-    else
+    return move;
+}
+
+std::string Chess::moveToString(const Move& move)
+{
+    std::string result = {static_cast<char>('a' + fileOf(move.from)), static_cast<char>('1' + rankOf(move.from)),
+        static_cast<char>('a' + fileOf(move.to)), static_cast<char>('1' + rankOf(move.to))};
+
+    if (move.type == MoveType::Promote)
     {
-        m_player_turn = FigureColor::White;
+        result += "pnbrqk"[static_cast<int>(move.promote)];
     }
+
+    return result;
 }
 
-FigureColor Chess::getPlayerType() const
+bool Chess::checkInput(const std::string& move)
+{ 
+    return move.size() == 4 && 
+            borderCheck(move[0] - 'a') && borderCheck(move[1] - '1') && 
+            borderCheck(move[2] - 'a') && borderCheck(move[3] - '1');
+}
+
+void Chess::initializeCoordinates(Point& start, Point& end, const std::string& move)
 {
-    return m_player_turn;
+    start.x = move[1] - '1';
+    start.y = move[0] - 'a';
+    end.x = move[3] - '1';
+    end.y = move[2] - 'a';
+}
+
+int Chess::toSquare(const Point& coord)
+{
+    return makeSquare(coord.y, 7 - coord.x);
 }
 
-Player& Chess::getPlayer(FigureColor color)
+Point Chess::toPoint(int square)
 {
-    if (color == FigureColor::White)
+    return {7 - rankOf(square), fileOf(square)};
+}
+
+void Chess::setPiece(const Point& coord, Piece piece)
+{ 
+    Bitboard bit = squareBit(toSquare(coord));
+
+    int square = toSquare(coord);
+    int old_type = pieceTypeOn(square);
+
+    if (old_type != NO_PIECE)
     {
-        return m_white;
+        int color = (m_board.occupancy[1] & bit) ? 1 : 0;
+        removePiece(square, color, old_type);
+        m_hash ^= zobrist.piece[color][old_type][square];
     }
 
-    return m_black;
+    if (piece)
+    {
+        int color = static_cast<int>(piece.getColor());
+        int type = static_cast<int>(piece.getType());
+        putPiece(square, color, type);
+        m_hash ^= zobrist.piece[color][type][square];
+    }
 }
 
-bool Chess::checkCastle(const Point& start, const Point& end) const
+Piece Chess::getPiece(const Point& coord) const
 {
-    if (!isCheck(start))
+    int square = toSquare(coord);
+    int type = pieceTypeOn(square);
+
+    if (type == NO_PIECE)
     {
-        return false;
+        return Piece();
     }
 
-    checkMoveLinear(start, end);
+    FigureColor color = (m_board.occupancy[1] & squareBit(square)) ? FigureColor::Black : FigureColor::White;
+    return Piece(color, static_cast<FigureType>(type));
+}
 
-    King* king = dynamic_cast<King*>(getPiece(start));
-    Rook* rook = dynamic_cast<Rook*>(getPiece(end));
-    if (king && king->getCastleAvailable() &&
-        rook && rook->getCastleAvailable())
-    {
-        if (start.y > end.y)
-        {
-            m_current_move_type = MoveType::CastleLeft;
-        }
+bool Chess::borderCheck(int coord)
+{ 
+    return 0 <= coord && coord < 8; 
+};
 
-        else
-        {
-            m_current_move_type = MoveType::CastleRight;
-        }
-     
-        return true;
-    }
+Bitboard Chess::attackersTo(int square, Bitboard occupied) const
+{
+    return boardAttackers(m_board, square, occupied);
+}
 
-    return false;
+// true while the square is not attacked by the opponent of the side to move
+bool Chess::isCheck(const Point& coord) const
+{
+    int enemy = 1 - static_cast<int>(getPlayerType());
+    return !(attackersTo(toSquare(coord), m_board.all) & m_board.occupancy[enemy]);
 }
 
-void Chess::printBoard() const
-{    
-    for (int i = 0; i < 8; ++i)
-    {
-        std::cout << i + 1 << ' ';
+bool Chess::isAttacked(int square, int by_color) const
+{
+    return attackersTo(square, m_board.all) & m_board.occupancy[by_color];
+}
 
-        for (int j = 0; j < 8; ++j)
-        {
-            if (m_board[i][j])
-            {
-                m_board[i][j]->printPiece();
-                std::cout << ' ';
-            }
+int Chess::kingSquare(int color) const
+{
+    return lsb(m_board.pieces[color][static_cast<int>(FigureType::King)]);
+}
 
-            else
-            {
-                std::cout << "-- ";
-            }
-        }
+// enemy pieces giving check to the side to move
+Bitboard Chess::checkers() const
+{
+    int us = static_cast<int>(m_player_turn);
+    return attackersTo(kingSquare(us), m_board.all) & m_board.occupancy[1 - us];
+}
 
-        std::cout << std::endl;
-    }
+// pieces of color that are the only blocker between their king and an enemy slider
+Bitboard Chess::pinnedPieces(int color) const
+{
+    const Bitboard (&enemy)[6] = m_board.pieces[1 - color];
+    int king = kingSquare(color);
 
-    for (int i = 0; i < 8; ++i)
+    Bitboard snipers = (rookAttacks(king, 0) & (enemy[3] | enemy[4])) |
+            (bishopAttacks(king, 0) & (enemy[2] | enemy[4]));
+    Bitboard pinned = 0;
+
+    while (snipers)
     {
-        std::cout << "  " << static_cast<char>(i + 'a');
-    }
-    std::cout << "\n\n";
-}
+        Bitboard blockers = between(king, popLsb(snipers)) & m_board.all;
 
-Player::Player(const Point& king_position) : m_king_position(king_position) {} 
+        if (blockers && !moreThanOne(blockers))
+        {
+            pinned |= blockers & m_board.occupancy[color];
+        }
+    }
 
-void Player::setMove(const Point& start, const Point& end)
-{
-    m_last_move_start = start;
-    m_last_move_end = end;
+    return pinned;
 }
 
-Point Player::getMoveStart() const
+int Chess::pieceTypeOn(int square) const
 {
-    return m_last_move_start;
+    Bitboard bit = squareBit(square);
+
+    if (!(m_board.all & bit))
+    {
+        return NO_PIECE;
+    }
+
+    int color = (m_board.occupancy[1] & bit) ? 1 : 0;
+
+    for (int type = 0; type < 5; ++type)
+    {
+        if (m_board.pieces[color][type] & bit)
+        {
+            return type;
+        }
+    }
+
+    return static_cast<int>(FigureType::King);
 }
 
-Point Player::getMoveEnd() const
+inline void Chess::putPiece(int square, int color, int type)
 {
-    return m_last_move_end;
+    Bitboard bit = squareBit(square);
+
+    m_board.pieces[color][type] |= bit;
+    m_board.occupancy[color] |= bit;
+    m_board.all |= bit;
+
+    m_psq += psq.score[color][type][square];
+    m_phase += phase_weight[type];
+
+    if (type == static_cast<int>(FigureType::Pawn))
+    {
+        m_pawn_key ^= zobrist.piece[color][type][square];
+    }
+
+    if (m_network)
+    {
+        m_network->addPiece(m_accumulator, color, type, square);
+    }
 }
 
-void Player::setKingPosition(const Point& pos)
+inline void Chess::removePiece(int square, int color, int type)
 {
-    m_king_position = pos;
+    Bitboard bit = squareBit(square);
+
+    m_board.pieces[color][type] ^= bit;
+    m_board.occupancy[color] ^= bit;
+    m_board.all ^= bit;
+
+    m_psq -= psq.score[color][type][square];
+    m_phase -= phase_weight[type];
+
+    if (type == static_cast<int>(FigureType::Pawn))
+    {
+        m_pawn_key ^= zobrist.piece[color][type][square];
+    }
+
+    if (m_network)
+    {
+        m_network->removePiece(m_accumulator, color, type, square);
+    }
 }
 
-Point Player::getKingPosition() const
+inline void Chess::shiftPiece(int from, int to, int color, int type)
 {
-    return m_king_position;
-}
+    Bitboard bits = squareBit(from) | squareBit(to);
 
-Piece::Piece(FigureType type, FigureColor color, int value) : m_type(type), m_color(color), m_value(value) {}
+    m_board.pieces[color][type] ^= bits;
+    m_board.occupancy[color] ^= bits;
+    m_board.all ^= bits;
 
-char Piece::getFigureColor() const
+    m_psq += psq.score[color][type][to];
+    m_psq -= psq.score[color][type][from];
+
+    if (type == static_cast<int>(FigureType::Pawn))
+    {
+        m_pawn_key ^= zobrist.piece[color][type][from] ^ zobrist.piece[color][type][to];
+    }
+
+    if (m_network)
+    {
+        m_network->movePiece(m_accumulator, color, type, from, to);
+    }
+}
+
+std::uint64_t Chess::computePawnKey() const
 {
-    if (m_color == FigureColor::White)
+    std::uint64_t key = 0;
+
+    for (int color = 0; color < 2; ++color)
     {
-        return 'W';
+        Bitboard pawns = m_board.pieces[color][static_cast<int>(FigureType::Pawn)];
+        while (pawns)
+        {
+            key ^= zobrist.piece[color][static_cast<int>(FigureType::Pawn)][popLsb(pawns)];
+        }
     }
 
-    return 'B';
+    return key;
 }
 
-char Piece::getFigureType() const
+std::uint64_t Chess::computeHash() const
 {
-    switch (m_type) {
-        case FigureType::Pawn:
-            return 'P';
+    std::uint64_t hash = zobrist.castle[m_castle_rights];
+
+    for (int color = 0; color < 2; ++color)
+    {
+        for (int type = 0; type < 6; ++type)
+        {
+            Bitboard pieces = m_board.pieces[color][type];
+            while (pieces)
+            {
+                hash ^= zobrist.piece[color][type][popLsb(pieces)];
+            }
+        }
+    }
 
-        case FigureType::Knight:
-            return 'N';
+    if (m_en_passant != NO_SQUARE)
+    {
+        hash ^= zobrist.en_passant[fileOf(m_en_passant)];
+    }
 
-        case FigureType::Bishop:
-            return 'B';
-    
-        case FigureType::Rook:
-            return 'R';
-    
-        case FigureType::Queen:
-            return 'Q';
-    
-        case FigureType::King:
-            return 'K';
+    if (m_player_turn == FigureColor::Black)
+    {
+        hash ^= zobrist.side;
     }
 
-    return '\0'; // for no warnings
+    return hash;
 }
 
-Pawn::Pawn(FigureColor color) : Piece(FigureType::Pawn, color, 1) , m_double_move(0) {}
+std::uint64_t Chess::getHash() const
+{
+    return m_hash;
+}
 
-void Pawn::setDoubleMove(bool value)
+std::uint64_t Chess::getPawnKey() const
 {
-    m_double_move = value;
+    return m_pawn_key;
 }
 
-bool Pawn::getDoubleMove() const
+Move Chess::lastMove() const
 {
-    return m_double_move;
+    return m_undo_size > m_undo_first ? m_undo[(m_undo_size - 1) & (UNDO_PLIES - 1)].move : NO_MOVE;
 }
 
-bool Pawn::checkMove(Chess* const game, const Point& start, const Point& end) const
+void Chess::doMove(const Move& move)
 {
-    int delta_x = end.x - start.x;
-    int delta_y = end.y - start.y;
+    const int pawn = static_cast<int>(FigureType::Pawn);
+    const int rook = static_cast<int>(FigureType::Rook);
+
+    int us = static_cast<int>(m_player_turn);
+    int them = 1 - us;
+    int type = pieceTypeOn(move.from);
 
-    if (end.x == 0 || end.x == 7)
+    int eaten_square = move.to;
+    if (move.type == MoveType::Passant)
     {
-        game->setMoveType(MoveType::Promote);
+        eaten_square = (us == 0) ? move.to - 8 : move.to + 8;
     }
 
-    if (delta_y == 0)
+    int captured = pieceTypeOn(eaten_square);
+
+    pushUndo({m_hash, move, static_cast<std::int8_t>(captured), static_cast<std::uint8_t>(m_castle_rights),
+        static_cast<std::int8_t>(m_en_passant), static_cast<std::uint16_t>(m_halfmove_clock)});
+
+    std::uint64_t hash = m_hash ^ zobrist.side ^ zobrist.castle[m_castle_rights];
+
+    if (m_en_passant != NO_SQUARE)
     {
-        if (getFigureColor() == 'W')
-        {
-            if (delta_x == -1)
-            {
-                return true;
-            }
+        hash ^= zobrist.en_passant[fileOf(m_en_passant)];
+    }
 
-            if (delta_x == -2 && start.x == 6)
-            {
-                if (!game->getPiece({start.x - 1, start.y}))
-                {
-                    return true;
-                }       
-            }
+    if (captured != NO_PIECE)
+    {
+        removePiece(eaten_square, them, captured);
+        hash ^= zobrist.piece[them][captured][eaten_square];
+    }
 
-            return false;
-        }// else
+    shiftPiece(move.from, move.to, us, type);
+    hash ^= zobrist.piece[us][type][move.from] ^ zobrist.piece[us][type][move.to];
 
-        if (delta_x == 1)
-        {
-            return true;
-        }
+    switch (move.type)
+    {
+        case MoveType::Promote:
+            removePiece(move.to, us, pawn);
+            putPiece(move.to, us, static_cast<int>(move.promote));
+            hash ^= zobrist.piece[us][pawn][move.to] ^ zobrist.piece[us][static_cast<int>(move.promote)][move.to];
+            break;
+
+        case MoveType::CastleLeft:
+            shiftPiece(move.to - 2, move.to + 1, us, rook);
+            hash ^= zobrist.piece[us][rook][move.to - 2] ^ zobrist.piece[us][rook][move.to + 1];
+            break;
+
+        case MoveType::CastleRight:
+            shiftPiece(move.to + 1, move.to - 1, us, rook);
+            hash ^= zobrist.piece[us][rook][move.to + 1] ^ zobrist.piece[us][rook][move.to - 1];
+            break;
+
+        default:
+            break;
+    }
+
+    m_castle_rights &= castleMask(move.from) & castleMask(move.to);
+    hash ^= zobrist.castle[m_castle_rights];
+
+    m_en_passant = NO_SQUARE;
+    ++m_halfmove_clock;
+
+    if (type == pawn || captured != NO_PIECE)
+    {
+        m_halfmove_clock = 0;
+    }
+
+    if (type == pawn && (move.to ^ move.from) == 16)
+    {
+        int skipped = (move.from + move.to) / 2;
 
-        if (delta_x == 2 && start.x == 1)
+        if (pawnAttacks(us, skipped) & m_board.pieces[them][pawn])
         {
-            if (!game->getPiece({start.x + 1, start.y}))
-            {
-                return true;
-            }
+            m_en_passant = skipped;
+            hash ^= zobrist.en_passant[fileOf(skipped)];
         }
+    }
 
-        return false;
+    m_hash = hash;
+    changeTurn();
+
+    assert(m_hash == computeHash());
+    assert(m_psq == computePsq());
+    assert(m_pawn_key == computePawnKey());
+}
+
+void Chess::undoMove()
+{
+    const int pawn = static_cast<int>(FigureType::Pawn);
+    const int rook = static_cast<int>(FigureType::Rook);
+
+    changeTurn();
+
+    const UndoInfo undo = popUndo();
+
+    const Move& move = undo.move;
+    int us = static_cast<int>(m_player_turn);
+
+    m_castle_rights = undo.castle_rights;
+    m_en_passant = undo.en_passant;
+    m_halfmove_clock = undo.halfmove_clock;
+    m_hash = undo.hash;
+
+    switch (move.type)
+    {
+        case MoveType::Promote:
+            removePiece(move.to, us, static_cast<int>(move.promote));
+            putPiece(move.to, us, pawn);
+            break;
+
+        case MoveType::CastleLeft:
+            shiftPiece(move.to + 1, move.to - 2, us, rook);
+            break;
+
+        case MoveType::CastleRight:
+            shiftPiece(move.to - 1, move.to + 1, us, rook);
+            break;
+
+        default:
+            break;
     }
 
-    if (((delta_x == 1 && getFigureColor() == 'B') || 
-            (delta_x == -1 && getFigureColor() == 'W')) && abs(delta_y) == 1)
+    shiftPiece(move.to, move.from, us, pieceTypeOn(move.to));
+
+    if (undo.captured != NO_PIECE)
     {
-        if (game->getPiece(end))
+        int eaten_square = move.to;
+        if (move.type == MoveType::Passant)
         {
-            return true;
+            eaten_square = (us == 0) ? move.to - 8 : move.to + 8;
         }
 
-        Point side = {start.x, start.y + delta_y};
-        Pawn* pawn = dynamic_cast<Pawn*>(game->getPiece(side));
-        if (pawn)
-        {
-            FigureColor color = FigureColor::White;
-            if (game->getPlayerType() != FigureColor::Black)
-            {
-                color = FigureColor::Black;
-            }
+        putPiece(eaten_square, 1 - us, undo.captured);
+    }
 
-            Player player = game->getPlayer(color);
-            Point last_move_start = player.getMoveStart();
-            Point last_move_end = player.getMoveEnd();
+    assert(m_hash == computeHash());
+    assert(m_psq == computePsq());
+    assert(m_pawn_key == computePawnKey());
+}
 
-            Point must_start = {end.x + delta_x, end.y};
+// passes the turn, for null-move pruning; never called while in check
+void Chess::doNullMove()
+{
+    pushUndo({m_hash, NO_MOVE, NO_PIECE, static_cast<std::uint8_t>(m_castle_rights),
+        static_cast<std::int8_t>(m_en_passant), static_cast<std::uint16_t>(m_halfmove_clock)});
 
-            if (last_move_start == must_start && last_move_end == side)
-            {
-                game->setMoveType(MoveType::Passant);
-                return true;
-            }
-        }
+    if (m_en_passant != NO_SQUARE)
+    {
+        m_hash ^= zobrist.en_passant[fileOf(m_en_passant)];
+        m_en_passant = NO_SQUARE;
     }
 
-    return false;
+    m_hash ^= zobrist.side;
+    ++m_halfmove_clock;
+
+    changeTurn();
 }
 
-void Pawn::printPiece() const
+void Chess::undoNullMove()
 {
-    std::cout << getFigureColor() << getFigureType();
+    changeTurn();
+
+    const UndoInfo undo = popUndo();
+
+    m_en_passant = undo.en_passant;
+    m_halfmove_clock = undo.halfmove_clock;
+    m_hash = undo.hash;
+}
+
+// past UNDO_PLIES plies the oldest record is overwritten
+void Chess::pushUndo(const UndoInfo& undo)
+{
+    if (m_undo_size - m_undo_first == UNDO_PLIES)
+    {
+        ++m_undo_first;
+    }
+
+    m_undo[m_undo_size++ & (UNDO_PLIES - 1)] = undo;
 }
 
-Knight::Knight(FigureColor color) : Piece(FigureType::Knight, color, 3) {}
+UndoInfo Chess::popUndo()
+{
+    assert(m_undo_size > m_undo_first);
+    return m_undo[--m_undo_size & (UNDO_PLIES - 1)];
+}
 
-void Knight::printPiece() const
+// NO_MOVE unless text is a legal move in coordinate notation, e.g. e2e4, e1g1 or e7e8q
+Move Chess::parseMove(const std::string& text) const
 {
-    std::cout << getFigureColor() << getFigureType();
+    if ((text.size() != 4 && text.size() != 5) || !borderCheck(text[0] - 'a') || !borderCheck(text[1] - '1') ||
+            !borderCheck(text[2] - 'a') || !borderCheck(text[3] - '1'))
+    {
+        return NO_MOVE;
+    }
+
+    int from = makeSquare(text[0] - 'a', text[1] - '1');
+    int to = makeSquare(text[2] - 'a', text[3] - '1');
+    int type = pieceTypeOn(from);
+
+    Move move = {static_cast<std::uint8_t>(from), static_cast<std::uint8_t>(to), MoveType::None, FigureType::Queen};
+
+    if (text.size() == 5)
+    {
+        std::size_t promote = std::string("nbrq").find(text[4]);
+        if (promote == std::string::npos)
+        {
+            return NO_MOVE;
+        }
+
+        move.type = MoveType::Promote;
+        move.promote = static_cast<FigureType>(promote + 1);
+    }
+
+    else if (type == static_cast<int>(FigureType::King) && std::abs(to - from) == 2)
+    {
+        move.type = to > from ? MoveType::CastleRight : MoveType::CastleLeft;
+    }
+
+    else if (type == static_cast<int>(FigureType::Pawn) && to == m_en_passant)
+    {
+        move.type = MoveType::Passant;
+    }
+
+    return isLegalMove(move) ? move : NO_MOVE;
 }
 
-bool Knight::checkMove(Chess* const game, const Point& start, const Point& end) const
+bool Chess::applyMove(const Move& move)
 {
-    int delta_x = abs(end.x - start.x);
-    int delta_y = abs(end.y - start.y);
-    return (delta_x == 2 && delta_y == 1) || 
-        (delta_x == 1 && delta_y == 2);
+    if (!isLegalMove(move))
+    {
+        return false;
+    }
+
+    doMove(move);
+    return true;
 }
 
-Bishop::Bishop(FigureColor color) : Piece(FigureType::Bishop, color, 3) {}
+bool Chess::tryMove(const std::string& text)
+{
+    Move move = parseMove(text);
+    if (move == NO_MOVE)
+    {
+        return false;
+    }
+
+    doMove(move);
+    return true;
+}
 
-bool Bishop::checkMove(Chess* const game, const Point& start, const Point& end) const
+int Chess::gamePly() const
 {
-    return game->checkMoveDiagonal(start, end);
+    return m_undo_size;
 }
 
-void Bishop::printPiece() const
+int Chess::undoPlies() const
 {
-    std::cout << getFigureColor() << getFigureType();
+    return m_undo_size - m_undo_first;
 }
 
-Rook::Rook(FigureColor color, bool castle_available) : Piece(FigureType::Rook, color, 5), m_castle_available(castle_available) {}
+bool Chess::inCheck() const
+{
+    return checkers();
+}
 
-void Rook::setCastleAvailable(bool value)
+bool Chess::isCapture(const Move& move) const
 {
-    m_castle_available = value;
+    return move.type == MoveType::Passant || (m_board.all & squareBit(move.to));
 }
 
-bool Rook::getCastleAvailable() const
+bool Chess::hasNonPawnMaterial() const
 {
-    return m_castle_available;
+    const Bitboard (&pieces)[6] = m_board.pieces[static_cast<int>(m_player_turn)];
+    return pieces[1] | pieces[2] | pieces[3] | pieces[4];
 }
 
-bool Rook::checkMove(Chess* const game, const Point& start, const Point& end) const
+// Times the current position stood on the board before, scanning the hashes back
+// to the last capture or pawn move, or to a null move, since nothing before
+// either can come back. Stops once limit earlier positions are found, and counts
+// only those at most within plies back when within is not negative.
+int Chess::countRepetitions(int limit, int within) const
 {
-    if (game->checkMoveLinear(start, end))
+    int size = m_undo_size;
+    int oldest = std::max(m_undo_first, size - m_halfmove_clock);
+    int seen = 0;
+
+    for (int i = size - 1; i >= oldest; --i)
     {
-        game->setMoveType(MoveType::Rook);
-        return true;
+        const UndoInfo& undo = m_undo[i & (UNDO_PLIES - 1)];
+        if (undo.move == NO_MOVE)
+        {
+            break;
+        }
+
+        // same side to move only every second ply
+        if ((size - i) % 2 == 0 && undo.hash == m_hash)
+        {
+            if (within >= 0 && size - i <= within)
+            {
+                return limit;
+            }
+
+            if (++seen == limit)
+            {
+                break;
+            }
+        }
     }
 
-    return false;
+    return seen;
 }
 
-void Rook::printPiece() const
+// true when the current position already stood on the board count - 1 times before
+bool Chess::isRepetition(int count) const
 {
-    std::cout << getFigureColor() << getFigureType();
+    return countRepetitions(count - 1, -1) == count - 1;
 }
 
-Queen::Queen(FigureColor color) : Piece(FigureType::Queen, color, 9) {}
-
-bool Queen::checkMove(Chess* const game, const Point& start, const Point& end) const
+// Search scores these as draws: the fifty move rule, any repetition of a position
+// inside the tree (the side that can vary would have), or a position that already
+// stood on the board twice before the root.
+bool Chess::isDraw(int ply) const
 {
-    return game->checkMoveLinear(start, end) || game->checkMoveDiagonal(start, end);
+    return m_halfmove_clock >= 100 || countRepetitions(2, ply) == 2;
 }
 
-void Queen::printPiece() const
+// neither side can mate: bare kings, a single minor piece, or only bishops on one square color
+bool Chess::isInsufficientMaterial() const
 {
-    std::cout << getFigureColor() << getFigureType();
+    const Bitboard light_squares = 0x55AA55AA55AA55AAULL;
+
+    const Bitboard (&white)[6] = m_board.pieces[0];
+    const Bitboard (&black)[6] = m_board.pieces[1];
+
+    if (white[0] | black[0] | white[3] | black[3] | white[4] | black[4])
+    {
+        return false;
+    }
+
+    Bitboard knights = white[1] | black[1];
+    Bitboard bishops = white[2] | black[2];
+
+    if (!moreThanOne(knights | bishops))
+    {
+        return true;
+    }
+
+    return !knights && (!(bishops & light_squares) || !(bishops & ~light_squares));
 }
 
-King::King(FigureColor color) : Piece(FigureType::King, color, 0), m_castle_available(true) {}
+// checkmate and stalemate first, since a mate on the hundredth half move still counts
+GameResult Chess::checkGameOver() const
+{
+    if (!hasLegalMove())
+    {
+        return checkers() ? GameResult::Checkmate : GameResult::Stalemate;
+    }
+
+    if (m_halfmove_clock >= 100)
+    {
+        return GameResult::FiftyMoves;
+    }
+
+    if (isRepetition(3))
+    {
+        return GameResult::Repetition;
+    }
+
+    if (isInsufficientMaterial())
+    {
+        return GameResult::InsufficientMaterial;
+    }
 
-void King::setCastleAvailable(bool value)
+    return GameResult::Ongoing;
+}
+
+// the typed squares are looked up among the legal moves, which also tell castling,
+// en passant and promotion apart; "undo" and "redo" are handed back as typed
+std::string Chess::readMove() const
 {
-    m_castle_available = value;
+    Point start;
+    Point end;
+    while (true)
+    {
+        if (m_player_turn == FigureColor::White)
+        {
+            std::cout << "White's turn: ";
+        }
+
+        else
+        {
+            std::cout << "Black's turn: ";
+        }
+
+        std::string move;
+        std::getline(std::cin, move);
+
+        std::cout << std::endl;
+
+        if (move == "undo" || move == "redo")
+        {
+            return move;
+        }
+
+        if (checkInput(move))
+        {
+            initializeCoordinates(start, end, move);
+
+            // the board labels count rows from black's side, tryMove wants coordinate notation
+            std::string uci = moveToString({static_cast<std::uint8_t>(toSquare(start)),
+                static_cast<std::uint8_t>(toSquare(end)), MoveType::None, FigureType::Queen});
+
+            if (parseMove(uci + 'q') != NO_MOVE)
+            {
+                std::cout << "Enter the Promoted piece type: Knight(N), Bishop(B), Rook(R), Queen(Q): ";
+
+                static const std::string figures = "NBRQ";
+                char figure_type = 0;
+
+                while (std::cin >> figure_type && figures.find(figure_type) == std::string::npos) {}
+                std::cin.ignore();
+
+                uci += static_cast<char>(std::tolower(figure_type));
+            }
+
+            if (parseMove(uci) != NO_MOVE)
+            {
+                return uci;
+            }
+        }
+    }
 }
 
-bool King::getCastleAvailable() const
+void Chess::changeTurn()
 {
-    return m_castle_available;
+    if (m_player_turn == FigureColor::White)
+    {
+        m_player_turn = FigureColor::Black;
+    }
+
+    else
+    {
+        m_player_turn = FigureColor::White;
+    }
 }
 
-bool King::checkMove(Chess* const game, const Point& start, const Point& end) const
+FigureColor Chess::getPlayerType() const
 {
-    int delta_x = end.x - start.x;
-    int delta_y = end.y - start.y;
-    
-    if (abs(delta_x) <= 1 && abs(delta_y) <= 1)
+    return m_player_turn;
+}
+
+void Chess::printBoard() const
+{    
+    for (int i = 0; i < 8; ++i)
     {
-        game->setMoveType(MoveType::King);
-        return true;
+        std::cout << i + 1 << ' ';
+
+        for (int j = 0; j < 8; ++j)
+        {
+            Piece piece = getPiece({i, j});
+            if (piece)
+            {
+                piece.printPiece();
+                std::cout << ' ';
+            }
+
+            else
+            {
+                std::cout << "-- ";
+            }
+        }
+
+        std::cout << std::endl;
     }
 
-    if (delta_y == -2)
+    for (int i = 0; i < 8; ++i)
     {
-        return game->checkCastle(start, {end.x, end.y - 2});
+        std::cout << "  " << static_cast<char>(i + 'a');
     }
+    std::cout << "\n\n";
+}
 
-    if (delta_y == 2)
+char Piece::getFigureColor() const
+{
+    if (getColor() == FigureColor::White)
     {
-        return game->checkCastle(start, {end.x, end.y + 1});
+        return 'W';
     }
 
-    return false;
+    return 'B';
+}
+
+char Piece::getFigureType() const
+{
+    return "PNBRQK"[static_cast<int>(getType())];
 }
 
-void King::printPiece() const
+void Piece::printPiece() const
 {
     std::cout << getFigureColor() << getFigureType();
 }
-
@@ -0,0 +1,180 @@
+#ifndef EVALUATE_H
+#define EVALUATE_H
+
+#include "bitboard.h"
+
+// middlegame and endgame halves of an evaluation term, blended by the game phase
+struct Score {
+    int mg;
+    int eg;
+
+    constexpr Score& operator+=(const Score& s2)
+    {
+        mg += s2.mg;
+        eg += s2.eg;
+        return *this;
+    }
+
+    constexpr Score& operator-=(const Score& s2)
+    {
+        mg -= s2.mg;
+        eg -= s2.eg;
+        return *this;
+    }
+
+    constexpr bool operator==(const Score& s2) const
+    {
+        return mg == s2.mg && eg == s2.eg;
+    }
+};
+
+// material per FigureType in pawns, the king has none
+constexpr int piece_value[6] = {1, 3, 3, 5, 9, 0};
+
+// how much each piece counts towards the middlegame, 24 with all pieces on the board
+constexpr int phase_weight[6] = {0, 1, 1, 2, 4, 0};
+constexpr int PHASE_MIDGAME = 24;
+
+// Piece-square bonuses in centipawns, seen from white with a8 first as on a
+// printed board; black uses the same tables mirrored vertically.
+constexpr int pawn_mg[SQUARE_NB] = {
+     0,   0,   0,   0,   0,   0,   0,   0,
+    50,  50,  50,  50,  50,  50,  50,  50,
+    10,  10,  20,  30,  30,  20,  10,  10,
+     5,   5,  10,  25,  25,  10,   5,   5,
+     0,   0,   0,  20,  20,   0,   0,   0,
+     5,  -5, -10,   0,   0, -10,  -5,   5,
+     5,  10,  10, -20, -20,  10,  10,   5,
+     0,   0,   0,   0,   0,   0,   0,   0
+};
+
+constexpr int pawn_eg[SQUARE_NB] = {
+     0,   0,   0,   0,   0,   0,   0,   0,
+    80,  80,  80,  80,  80,  80,  80,  80,
+    50,  50,  50,  50,  50,  50,  50,  50,
+    30,  30,  30,  30,  30,  30,  30,  30,
+    15,  15,  15,  15,  15,  15,  15,  15,
+     5,   5,   5,   5,   5,   5,   5,   5,
+     0,   0,   0,   0,   0,   0,   0,   0,
+     0,   0,   0,   0,   0,   0,   0,   0
+};
+
+constexpr int knight_psq[SQUARE_NB] = {
+   -50, -40, -30, -30, -30, -30, -40, -50,
+   -40, -20,   0,   0,   0,   0, -20, -40,
+   -30,   0,  10,  15,  15,  10,   0, -30,
+   -30,   5,  15,  20,  20,  15,   5, -30,
+   -30,   0,  15,  20,  20,  15,   0, -30,
+   -30,   5,  10,  15,  15,  10,   5, -30,
+   -40, -20,   0,   5,   5,   0, -20, -40,
+   -50, -40, -30, -30, -30, -30, -40, -50
+};
+
+constexpr int bishop_psq[SQUARE_NB] = {
+   -20, -10, -10, -10, -10, -10, -10, -20,
+   -10,   0,   0,   0,   0,   0,   0, -10,
+   -10,   0,   5,  10,  10,   5,   0, -10,
+   -10,   5,   5,  10,  10,   5,   5, -10,
+   -10,   0,  10,  10,  10,  10,   0, -10,
+   -10,  10,  10,  10,  10,  10,  10, -10,
+   -10,   5,   0,   0,   0,   0,   5, -10,
+   -20, -10, -10, -10, -10, -10, -10, -20
+};
+
+constexpr int rook_psq[SQUARE_NB] = {
+     0,   0,   0,   0,   0,   0,   0,   0,
+     5,  10,  10,  10,  10,  10,  10,   5,
+    -5,   0,   0,   0,   0,   0,   0,  -5,
+    -5,   0,   0,   0,   0,   0,   0,  -5,
+    -5,   0,   0,   0,   0,   0,   0,  -5,
+    -5,   0,   0,   0,   0,   0,   0,  -5,
+    -5,   0,   0,   0,   0,   0,   0,  -5,
+     0,   0,   0,   5,   5,   0,   0,   0
+};
+
+constexpr int queen_psq[SQUARE_NB] = {
+   -20, -10, -10,  -5,  -5, -10, -10, -20,
+   -10,   0,   0,   0,   0,   0,   0, -10,
+   -10,   0,   5,   5,   5,   5,   0, -10,
+    -5,   0,   5,   5,   5,   5,   0,  -5,
+     0,   0,   5,   5,   5,   5,   0,  -5,
+   -10,   5,   5,   5,   5,   5,   0, -10,
+   -10,   0,   5,   0,   0,   0,   0, -10,
+   -20, -10, -10,  -5,  -5, -10, -10, -20
+};
+
+constexpr int king_mg[SQUARE_NB] = {
+   -30, -40, -40, -50, -50, -40, -40, -30,
+   -30, -40, -40, -50, -50, -40, -40, -30,
+   -30, -40, -40, -50, -50, -40, -40, -30,
+   -30, -40, -40, -50, -50, -40, -40, -30,
+   -20, -30, -30, -40, -40, -30, -30, -20,
+   -10, -20, -20, -20, -20, -20, -20, -10,
+    20,  20,   0,   0,   0,   0,  20,  20,
+    20,  30,  10,   0,   0,  10,  30,  20
+};
+
+constexpr int king_eg[SQUARE_NB] = {
+   -50, -40, -30, -20, -20, -30, -40, -50,
+   -30, -20, -10,   0,   0, -10, -20, -30,
+   -30, -10,  20,  30,  30,  20, -10, -30,
+   -30, -10,  30,  40,  40,  30, -10, -30,
+   -30, -10,  30,  40,  40,  30, -10, -30,
+   -30, -10,  20,  30,  30,  20, -10, -30,
+   -30, -30,   0,   0,   0,   0, -30, -30,
+   -50, -30, -30, -30, -30, -30, -30, -50
+};
+
+// pawn structure terms, per pawn
+constexpr Score DOUBLED_PAWN = {-10, -20};
+constexpr Score ISOLATED_PAWN = {-10, -15};
+constexpr Score BACKWARD_PAWN = {-8, -10};
+
+// passed pawns by rank counted from their own side
+constexpr Score passed_pawn[8] = {{0, 0}, {5, 10}, {10, 20}, {20, 35}, {35, 60}, {60, 100}, {100, 150}, {0, 0}};
+
+// a passed pawn with a piece of either side on the square in front of it
+constexpr Score BLOCKED_PASSER = {-5, -25};
+
+// knight or bishop on the 4th to 6th rank, guarded by an own pawn, on a square
+// no enemy pawn can ever attack
+constexpr Score MINOR_OUTPOST = {20, 10};
+
+// middlegame only, per file next to the king
+constexpr int SHELTER_NEAR = 10; // own pawn one rank ahead of the king
+constexpr int SHELTER_FAR = 5; // two ranks ahead
+constexpr int SHELTER_OPEN = -15; // no own pawn ahead at all
+
+// material plus piece-square bonus for every piece on every square, positive
+// for white and negative for black, so a position's score is a plain sum
+struct PsqTable {
+    Score score[2][6][SQUARE_NB]; // [FigureColor][FigureType][square]
+};
+
+constexpr PsqTable makePsqTable()
+{
+    const int* const mg_tables[6] = {pawn_mg, knight_psq, bishop_psq, rook_psq, queen_psq, king_mg};
+    const int* const eg_tables[6] = {pawn_eg, knight_psq, bishop_psq, rook_psq, queen_psq, king_eg};
+
+    PsqTable table = {};
+
+    for (int type = 0; type < 6; ++type)
+    {
+        for (int square = 0; square < SQUARE_NB; ++square)
+        {
+            // the tables start at a8, a white piece on square reads row 7 - rank
+            int index = square ^ 56;
+            Score white = {piece_value[type] * 100 + mg_tables[type][index],
+                piece_value[type] * 100 + eg_tables[type][index]};
+
+            table.score[0][type][square] = white;
+            table.score[1][type][square ^ 56] = {-white.mg, -white.eg};
+        }
+    }
+
+    return table;
+}
+
+inline constexpr PsqTable psq = makePsqTable();
+
+#endif
@@ -0,0 +1,203 @@
+#include "chess.h"
+
+// the material and piece-square sum rebuilt from the bitboards, for the debug checks
+Score Chess::computePsq() const
+{
+    Score score = {0, 0};
+
+    for (int color = 0; color < 2; ++color)
+    {
+        for (int type = 0; type < 6; ++type)
+        {
+            Bitboard pieces = m_board.pieces[color][type];
+            while (pieces)
+            {
+                score += psq.score[color][type][popLsb(pieces)];
+            }
+        }
+    }
+
+    return score;
+}
+
+static constexpr Bitboard FILE_A_BB = 0x0101010101010101ULL;
+
+// every rank strictly in front of rank, seen from color
+static Bitboard ranksAhead(int color, int rank)
+{
+    if (color == 0)
+    {
+        return rank == 7 ? 0 : ~Bitboard(0) << (8 * (rank + 1));
+    }
+
+    return (Bitboard(1) << (8 * rank)) - 1;
+}
+
+static Bitboard adjacentFiles(int file)
+{
+    Bitboard file_bb = FILE_A_BB << file;
+    return (file > 0 ? file_bb >> 1 : 0) | (file < 7 ? file_bb << 1 : 0);
+}
+
+// Everything that depends on the pawns alone, so it can be cached by pawn key.
+void Chess::evaluatePawns(PawnEntry& entry) const
+{
+    const int pawn = static_cast<int>(FigureType::Pawn);
+
+    entry.score = {0, 0};
+
+    for (int color = 0; color < 2; ++color)
+    {
+        Bitboard ours = m_board.pieces[color][pawn];
+        Bitboard theirs = m_board.pieces[color ^ 1][pawn];
+        Score score = {0, 0};
+
+        entry.passed[color] = 0;
+        entry.attacks[color] = 0;
+        entry.attack_span[color] = 0;
+
+        Bitboard pawns = ours;
+        while (pawns)
+        {
+            int square = popLsb(pawns);
+            int file = fileOf(square);
+            int rank = rankOf(square);
+
+            Bitboard file_bb = FILE_A_BB << file;
+            Bitboard adjacent = adjacentFiles(file);
+            Bitboard ahead = ranksAhead(color, rank);
+
+            entry.attacks[color] |= pawnAttacks(color, square);
+            entry.attack_span[color] |= adjacent & ahead;
+
+            if (!(theirs & (file_bb | adjacent) & ahead))
+            {
+                entry.passed[color] |= squareBit(square);
+                score += passed_pawn[color == 0 ? rank : 7 - rank];
+            }
+
+            if (ours & file_bb & ahead)
+            {
+                score += DOUBLED_PAWN;
+            }
+
+            if (!(ours & adjacent))
+            {
+                score += ISOLATED_PAWN;
+            }
+            // no neighbour level or behind to support it, and it cannot step up safely
+            else if (!(ours & adjacent & ~ahead) &&
+                    (pawnAttacks(color, color == 0 ? square + 8 : square - 8) & theirs))
+            {
+                score += BACKWARD_PAWN;
+            }
+        }
+
+        if (color == 0)
+        {
+            entry.score += score;
+        }
+        else
+        {
+            entry.score -= score;
+        }
+    }
+}
+
+// Middlegame bonus for own pawns in front of the king on its file and the two
+// next to it. Depends on the king square too, so it is not part of the pawn cache.
+int Chess::kingShelter(int color) const
+{
+    Bitboard ours = m_board.pieces[color][static_cast<int>(FigureType::Pawn)];
+    int king = kingSquare(color);
+    int rank = rankOf(king);
+    int center = fileOf(king) < 1 ? 1 : fileOf(king) > 6 ? 6 : fileOf(king);
+    int push = color == 0 ? 8 : -8;
+    int shelter = 0;
+
+    for (int file = center - 1; file <= center + 1; ++file)
+    {
+        Bitboard shield = ours & (FILE_A_BB << file) & ranksAhead(color, rank);
+        int near = makeSquare(file, rank) + push;
+
+        if (!shield)
+        {
+            shelter += SHELTER_OPEN;
+        }
+        else if (shield & squareBit(near))
+        {
+            shelter += SHELTER_NEAR;
+        }
+        else if (shield & squareBit(near + push))
+        {
+            shelter += SHELTER_FAR;
+        }
+    }
+
+    return shelter;
+}
+
+// Terms that need the cached pawn entry and the pieces together, so they are
+// worked out on every evaluation: blocked passed pawns and minor piece outposts.
+Score Chess::pawnPieceTerms(const PawnEntry& pawns, int color) const
+{
+    const Bitboard outpost_ranks = color == 0 ? 0x0000FFFFFF000000ULL : 0x000000FFFFFF0000ULL;
+
+    Score score = {0, 0};
+
+    Bitboard passed = pawns.passed[color];
+    Bitboard stops = color == 0 ? passed << 8 : passed >> 8;
+    int blocked = popCount(stops & m_board.all);
+
+    Bitboard minors = m_board.pieces[color][static_cast<int>(FigureType::Knight)] |
+            m_board.pieces[color][static_cast<int>(FigureType::Bishop)];
+    int outposts = popCount(minors & outpost_ranks & pawns.attacks[color] & ~pawns.attack_span[color ^ 1]);
+
+    score.mg = blocked * BLOCKED_PASSER.mg + outposts * MINOR_OUTPOST.mg;
+    score.eg = blocked * BLOCKED_PASSER.eg + outposts * MINOR_OUTPOST.eg;
+
+    return score;
+}
+
+void Chess::setNetwork(const Network* network)
+{
+    m_network = network;
+
+    if (m_network)
+    {
+        m_network->refresh(m_accumulator, m_board.pieces);
+    }
+}
+
+// Tapered material, piece-square and pawn structure score, positive when the
+// side to move is ahead. Both psq halves are kept up to date by putPiece/
+// removePiece/shiftPiece; the pawn terms come from pawn_table when the pawn key
+// is already there. With a network set, its accumulator is kept the same way
+// and only the output layer runs here.
+int Chess::evaluate(PawnTable* pawn_table) const
+{
+    if (m_network)
+    {
+        return m_network->evaluate(m_accumulator, static_cast<int>(m_player_turn));
+    }
+
+    PawnEntry local;
+    PawnEntry* pawns = &local;
+
+    if (!pawn_table || !pawn_table->probe(m_pawn_key, pawns))
+    {
+        evaluatePawns(*pawns);
+        pawns->key = m_pawn_key;
+    }
+
+    Score total = m_psq;
+    total += pawns->score;
+    total += pawnPieceTerms(*pawns, 0);
+    total -= pawnPieceTerms(*pawns, 1);
+    total.mg += kingShelter(0) - kingShelter(1);
+
+    int phase = m_phase < PHASE_MIDGAME ? m_phase : PHASE_MIDGAME;
+    int score = (total.mg * phase + total.eg * (PHASE_MIDGAME - phase)) / PHASE_MIDGAME;
+
+    return m_player_turn == FigureColor::White ? score : -score;
+}
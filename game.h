@@ -0,0 +1,33 @@
+#ifndef GAME_H
+#define GAME_H
+
+#include <string>
+#include <vector>
+#include "chess.h"
+
+// A game being played: the position plus every move since it was set up, so
+// takeback and redo reach back to the first move. The Chess keeps only the
+// undo records a search needs and stays cheap to copy for search threads;
+// a takeback past them replays the game from its start instead.
+class Game {
+    private:
+        Chess m_position;
+        std::string m_start_fen;
+        std::vector<Move> m_moves; // played, then the ones taken back
+        int m_ply; // moves of m_moves on the board
+
+    public:
+        Game();
+        ~Game() = default;
+
+        const Chess& position() const;
+        void setNetwork(const Network* network);
+
+        void playMove(const Move& move); // must be legal, forgets the moves taken back
+        bool takeBack(int plies = 1); // false, changing nothing, when fewer plies were played
+        bool redo(int plies = 1); // false, changing nothing, when fewer plies were taken back
+
+        void makeMove(int takeback_plies = 1); // from stdin, "undo" and "redo" step that many plies
+};
+
+#endif
@@ -0,0 +1,304 @@
+#include <cstring>
+#include "gamedb.h"
+
+static void put16(std::string& buffer, std::uint16_t value)
+{
+    buffer += static_cast<char>(value & 0xFF);
+    buffer += static_cast<char>(value >> 8);
+}
+
+static void put32(std::string& buffer, std::uint32_t value)
+{
+    put16(buffer, static_cast<std::uint16_t>(value));
+    put16(buffer, static_cast<std::uint16_t>(value >> 16));
+}
+
+static void put64(std::string& buffer, std::uint64_t value)
+{
+    put32(buffer, static_cast<std::uint32_t>(value));
+    put32(buffer, static_cast<std::uint32_t>(value >> 32));
+}
+
+static std::uint16_t get16(const unsigned char* data)
+{
+    return static_cast<std::uint16_t>(data[0] | (data[1] << 8));
+}
+
+static std::uint32_t get32(const unsigned char* data)
+{
+    return get16(data) | (static_cast<std::uint32_t>(get16(data + 2)) << 16);
+}
+
+static std::uint64_t get64(const unsigned char* data)
+{
+    return get32(data) | (static_cast<std::uint64_t>(get32(data + 4)) << 32);
+}
+
+static std::string header(std::uint64_t games, std::uint64_t index_offset)
+{
+    std::string buffer = "CGDB";
+    put32(buffer, GAMEDB_VERSION);
+    put64(buffer, games);
+    put64(buffer, index_offset);
+    return buffer;
+}
+
+GameOutcome outcomeFromResult(std::string_view result)
+{
+    if (result == "1-0")
+    {
+        return GameOutcome::WhiteWins;
+    }
+
+    if (result == "0-1")
+    {
+        return GameOutcome::BlackWins;
+    }
+
+    if (result == "1/2-1/2")
+    {
+        return GameOutcome::Draw;
+    }
+
+    return GameOutcome::Unknown;
+}
+
+const char* resultString(GameOutcome outcome)
+{
+    static const char* results[] = {"*", "1-0", "0-1", "1/2-1/2"};
+    return results[static_cast<int>(outcome)];
+}
+
+Move GameRecord::move(int ply) const
+{
+    return Move::unpack(get16(moves + 2 * ply));
+}
+
+GameDbWriter::GameDbWriter() : m_position(0) {}
+
+GameDbWriter::~GameDbWriter()
+{
+    close();
+}
+
+bool GameDbWriter::open(const std::string& path)
+{
+    close();
+
+    m_file.open(path, std::ios::binary | std::ios::trunc);
+    m_offsets.clear();
+
+    // a placeholder until close() knows the count and where the index goes
+    std::string placeholder = header(0, 0);
+    m_file.write(placeholder.data(), placeholder.size());
+    m_position = placeholder.size();
+
+    return static_cast<bool>(m_file);
+}
+
+bool GameDbWriter::addGame(const std::vector<Move>& moves, GameOutcome outcome, const std::string& fen)
+{
+    if (moves.size() > GAMEDB_MAX_PLIES || fen.size() > 65535 || !m_file.is_open())
+    {
+        return false;
+    }
+
+    m_buffer.clear();
+    m_buffer += static_cast<char>(outcome);
+    m_buffer += static_cast<char>(fen.empty() ? 0 : 1);
+    put16(m_buffer, static_cast<std::uint16_t>(moves.size()));
+
+    if (!fen.empty())
+    {
+        put16(m_buffer, static_cast<std::uint16_t>(fen.size()));
+        m_buffer += fen;
+    }
+
+    for (const Move& move : moves)
+    {
+        put16(m_buffer, move.pack());
+    }
+
+    m_offsets.push_back(m_position);
+    m_file.write(m_buffer.data(), m_buffer.size());
+    m_position += m_buffer.size();
+
+    return static_cast<bool>(m_file);
+}
+
+bool GameDbWriter::close()
+{
+    if (!m_file.is_open())
+    {
+        return true;
+    }
+
+    std::uint64_t index_offset = m_position;
+
+    m_buffer.clear();
+    for (std::uint64_t offset : m_offsets)
+    {
+        put64(m_buffer, offset);
+    }
+    put64(m_buffer, index_offset);
+
+    m_file.write(m_buffer.data(), m_buffer.size());
+
+    std::string final_header = header(m_offsets.size(), index_offset);
+    m_file.seekp(0);
+    m_file.write(final_header.data(), final_header.size());
+
+    bool ok = static_cast<bool>(m_file);
+    m_file.close();
+
+    return ok;
+}
+
+std::size_t GameDbWriter::size() const
+{
+    return m_offsets.size();
+}
+
+GameDb::GameDb() : m_index(nullptr), m_size(0) {}
+
+bool GameDb::open(const std::string& path)
+{
+    m_index = nullptr;
+    m_size = 0;
+
+    if (!m_file.open(path))
+    {
+        return false;
+    }
+
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(m_file.data());
+    std::size_t file_size = m_file.size();
+
+    if (file_size < GAMEDB_HEADER_SIZE || std::memcmp(data, "CGDB", 4) != 0 || get32(data + 4) != GAMEDB_VERSION)
+    {
+        m_file.close();
+        return false;
+    }
+
+    std::uint64_t games = get64(data + 8);
+    std::uint64_t index_offset = get64(data + 16);
+
+    if (index_offset > file_size || (file_size - index_offset) / 8 < games + 1)
+    {
+        m_file.close();
+        return false;
+    }
+
+    m_index = data + index_offset;
+    m_size = games;
+
+    return true;
+}
+
+std::size_t GameDb::size() const
+{
+    return m_size;
+}
+
+// a record must end where the next one starts, which open() checked lies in the file
+bool GameDb::game(std::size_t index, GameRecord& game) const
+{
+    if (index >= m_size)
+    {
+        return false;
+    }
+
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(m_file.data());
+    std::uint64_t offset = get64(m_index + 8 * index);
+    std::uint64_t end = get64(m_index + 8 * (index + 1));
+
+    if (offset < GAMEDB_HEADER_SIZE || offset > end || end > static_cast<std::uint64_t>(m_index - data) ||
+            end - offset < 4)
+    {
+        return false;
+    }
+
+    const unsigned char* record = data + offset;
+    std::uint64_t header = 4;
+
+    game.outcome = static_cast<GameOutcome>(record[0]);
+    game.fen = std::string_view();
+    game.plies = get16(record + 2);
+
+    if (record[1] & 1)
+    {
+        if (end - offset < 6)
+        {
+            return false;
+        }
+
+        std::uint16_t length = get16(record + 4);
+        game.fen = std::string_view(reinterpret_cast<const char*>(record + 6), length);
+        header = 6 + length;
+    }
+
+    game.moves = record + header;
+
+    return record[0] <= static_cast<unsigned char>(GameOutcome::Draw) && header + 2 * game.plies == end - offset;
+}
+
+// a FEN the position refuses leaves nothing to replay
+GameReplay::GameReplay(const GameRecord& game, Chess& position) : m_position(position), m_game(game), m_ply(0),
+    m_next(NO_MOVE), m_damaged(false)
+{
+    if (!m_position.fromFEN(game.fen.empty() ? START_FEN : std::string(game.fen)))
+    {
+        m_damaged = true;
+        return;
+    }
+
+    prepare();
+}
+
+void GameReplay::prepare()
+{
+    m_next = NO_MOVE;
+
+    if (m_ply >= m_game.plies)
+    {
+        return;
+    }
+
+    // NO_MOVE and unpacked garbage never pass isLegalMove
+    Move move = m_game.move(m_ply);
+    if (!m_position.isLegalMove(move))
+    {
+        m_damaged = true;
+        return;
+    }
+
+    m_next = move;
+}
+
+bool GameReplay::next()
+{
+    if (m_next == NO_MOVE)
+    {
+        return false;
+    }
+
+    m_position.doMove(m_next);
+    ++m_ply;
+    prepare();
+    return true;
+}
+
+Move GameReplay::nextMove() const
+{
+    return m_next;
+}
+
+int GameReplay::ply() const
+{
+    return m_ply;
+}
+
+bool GameReplay::damaged() const
+{
+    return m_damaged;
+}
@@ -0,0 +1,90 @@
+#include "game.h"
+
+Game::Game() : m_position(), m_start_fen(START_FEN), m_moves(), m_ply(0) {}
+
+const Chess& Game::position() const
+{
+    return m_position;
+}
+
+void Game::setNetwork(const Network* network)
+{
+    m_position.setNetwork(network);
+}
+
+void Game::playMove(const Move& move)
+{
+    m_moves.resize(m_ply);
+    m_moves.push_back(move);
+    ++m_ply;
+
+    m_position.doMove(move);
+}
+
+bool Game::takeBack(int plies)
+{
+    if (plies > m_ply)
+    {
+        return false;
+    }
+
+    m_ply -= plies;
+
+    if (plies <= m_position.undoPlies())
+    {
+        for (int i = 0; i < plies; ++i)
+        {
+            m_position.undoMove();
+        }
+    }
+
+    // the undo records of the oldest moves are gone, the game is played again
+    else
+    {
+        m_position.fromFEN(m_start_fen);
+
+        for (int i = 0; i < m_ply; ++i)
+        {
+            m_position.doMove(m_moves[i]);
+        }
+    }
+
+    return true;
+}
+
+bool Game::redo(int plies)
+{
+    if (plies > static_cast<int>(m_moves.size()) - m_ply)
+    {
+        return false;
+    }
+
+    for (int i = 0; i < plies; ++i)
+    {
+        m_position.doMove(m_moves[m_ply++]);
+    }
+
+    return true;
+}
+
+// asks again while "undo" or "redo" has nothing to step to
+void Game::makeMove(int takeback_plies)
+{
+    while (true)
+    {
+        std::string input = m_position.readMove();
+
+        if (input == "undo" || input == "redo")
+        {
+            if (input == "undo" ? takeBack(takeback_plies) : redo(takeback_plies))
+            {
+                return;
+            }
+
+            continue;
+        }
+
+        playMove(m_position.parseMove(input));
+        return;
+    }
+}
@@ -0,0 +1,403 @@
+#include "chess.h"
+#include "gamedb.h"
+#include "mappedfile.h"
+#include "pgn.h"
+#include "polyglot.h"
+#include "posindex.h"
+#include "timer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+static void usage()
+{
+    std::cout << "usage: gamedb convert [-j threads] out.cgdb in.pgn...    store the legal games of the PGN files" << std::endl;
+    std::cout << "       gamedb info file.cgdb                            game count, size and replay speed" << std::endl;
+    std::cout << "       gamedb show file.cgdb <game>                     moves and final position of one game, from 1" << std::endl;
+    std::cout << "       gamedb index [-j threads] [-m MB] file.cgdb out.cpix" << std::endl;
+    std::cout << "                                                        index every position of every game" << std::endl;
+    std::cout << "       gamedb find file.cpix [fen]                      games through a position, the start by default" << std::endl;
+    std::cout << "       gamedb book [-j threads] [-p plies] [-m MB] [-g games] file.cgdb out.bin" << std::endl;
+    std::cout << "                                                        Polyglot book of the first plies (40)" << std::endl;
+    std::cout << "       gamedb probe book.bin [fen]                      book moves in a position" << std::endl;
+}
+
+static int convert(const std::string& out, const std::vector<std::string>& inputs, int threads)
+{
+    GameDbWriter writer;
+    if (!writer.open(out))
+    {
+        std::cerr << "cannot write " << out << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::uint64_t skipped = 0;
+    std::uint64_t pgn_bytes = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    PgnReplayPool pool(threads, true);
+
+    auto store = [&writer, &skipped](const std::vector<PgnGame>& results)
+    {
+        for (const PgnGame& game : results)
+        {
+            const PgnCheck& check = game.check;
+
+            if (!check.legal || !writer.addGame(game.moves, outcomeFromResult(check.result), std::string(check.setup)))
+            {
+                ++skipped;
+            }
+        }
+    };
+
+    for (const std::string& path : inputs)
+    {
+        MappedFile file;
+        if (!file.open(path, true))
+        {
+            std::cerr << "cannot open " << path << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        pgn_bytes += file.size();
+
+        pool.replay(file.view(), store);
+    }
+
+    std::size_t stored = writer.size();
+    if (!writer.close())
+    {
+        std::cerr << "cannot write " << out << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    MappedFile written;
+    written.open(out);
+
+    std::cerr << stored << " games stored, " << skipped << " skipped as illegal, " << pgn_bytes << " bytes of PGN to "
+        << written.size() << " (" << (written.size() ? static_cast<double>(pgn_bytes) / written.size() : 0) << "x), "
+        << seconds(start) << "s" << std::endl;
+
+    return EXIT_SUCCESS;
+}
+
+static int info(const std::string& path)
+{
+    GameDb db;
+    if (!db.open(path))
+    {
+        std::cerr << "cannot open " << path << " as a game file" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::uint64_t positions = 0;
+    std::uint64_t checksum = 0;
+    Chess position;
+
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < db.size(); ++i)
+    {
+        GameRecord game;
+        if (!db.game(i, game))
+        {
+            std::cerr << "game " << i + 1 << " of " << path << " is damaged" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        GameReplay replay(game, position);
+        while (replay.next())
+        {
+            ++positions;
+        }
+
+        if (replay.damaged())
+        {
+            std::cerr << "game " << i + 1 << " of " << path << " is damaged" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        checksum ^= position.getHash();
+    }
+    double time = seconds(start);
+
+    MappedFile file;
+    file.open(path);
+
+    std::cout << "games      " << db.size() << std::endl;
+    std::cout << "positions  " << positions << std::endl;
+    std::cout << "bytes      " << file.size() << " (" << (db.size() ? file.size() / db.size() : 0) << " per game)" << std::endl;
+    std::cout << "replay     " << static_cast<std::uint64_t>(positions / (time > 0 ? time : 1e-9)) << " positions/s, "
+        << static_cast<std::uint64_t>(file.size() / (time > 0 ? time : 1e-9) / 1e6) << " MB/s, checksum " << std::hex
+        << checksum << std::dec << std::endl;
+
+    return EXIT_SUCCESS;
+}
+
+static int show(const std::string& path, std::size_t number)
+{
+    GameDb db;
+    if (!db.open(path))
+    {
+        std::cerr << "cannot open " << path << " as a game file" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (number < 1 || number > db.size())
+    {
+        std::cerr << "no game " << number << ", the file has " << db.size() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    GameRecord game;
+    if (!db.game(number - 1, game))
+    {
+        std::cerr << "game " << number << " of " << path << " is damaged" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    Chess position;
+    GameReplay replay(game, position);
+
+    std::cout << "start   " << position.toFEN() << std::endl;
+    std::cout << "moves  ";
+
+    Move move;
+    while ((move = replay.nextMove()) != NO_MOVE)
+    {
+        std::cout << ' ' << Chess::moveToString(move);
+        replay.next();
+    }
+
+    std::cout << std::endl;
+
+    if (replay.damaged())
+    {
+        std::cerr << "game " << number << " of " << path << " is damaged" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "end     " << position.toFEN() << std::endl;
+    std::cout << "result  " << resultString(game.outcome) << std::endl;
+
+    return EXIT_SUCCESS;
+}
+
+static int index(const std::string& path, const std::string& out, int threads, std::size_t memory_mb)
+{
+    GameDb db;
+    if (!db.open(path))
+    {
+        std::cerr << "cannot open " << path << " as a game file" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    if (!buildPositionIndex(db, out, threads, memory_mb))
+    {
+        std::cerr << "cannot write " << out << ", or " << path << " is damaged" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    PositionIndex index;
+    index.open(out);
+
+    std::cerr << index.size() << " positions from " << db.size() << " games indexed in " << seconds(start) << "s with "
+        << threads << " threads" << std::endl;
+
+    return EXIT_SUCCESS;
+}
+
+static int find(const std::string& path, const std::string& fen)
+{
+    PositionIndex index;
+    if (!index.open(path))
+    {
+        std::cerr << "cannot open " << path << " as a position index" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    Chess position;
+    if (!position.fromFEN(fen))
+    {
+        std::cerr << "bad FEN: " << fen << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    PositionStats stats = index.stats(position.getHash());
+    auto games = index.find(position.getHash());
+
+    std::cout << "games      " << stats.games << std::endl;
+    std::cout << "white      " << stats.white_wins << std::endl;
+    std::cout << "draws      " << stats.draws << std::endl;
+    std::cout << "black      " << stats.black_wins << std::endl;
+
+    // the first few, as numbered by gamedb show
+    int shown = 0;
+    for (const PositionEntry* entry = games.first; entry != games.second && shown < 10; ++entry, ++shown)
+    {
+        std::cout << "game " << entry->game + 1 << " ply " << entry->ply << " " << resultString(entry->outcome) << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+static int book(const std::string& path, const std::string& out, const BookBuildOptions& options)
+{
+    GameDb db;
+    if (!db.open(path))
+    {
+        std::cerr << "cannot open " << path << " as a game file" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    if (!buildPolyglotBook(db, out, options))
+    {
+        std::cerr << "cannot write " << out << ", or " << path << " is damaged" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    MappedFile written;
+    written.open(out);
+
+    std::cerr << written.size() / POLYGLOT_ENTRY_SIZE << " book entries from " << db.size() << " games in "
+        << seconds(start) << "s with " << options.threads << " threads" << std::endl;
+
+    return EXIT_SUCCESS;
+}
+
+static int probe(const std::string& path, const std::string& fen)
+{
+    PolyglotBook book;
+    if (!book.open(path))
+    {
+        std::cerr << "cannot open " << path << " as a Polyglot book" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    Chess position;
+    if (!position.fromFEN(fen))
+    {
+        std::cerr << "bad FEN: " << fen << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::vector<BookMove> moves = book.probe(position);
+
+    int total = 0;
+    for (const BookMove& move : moves)
+    {
+        total += move.weight;
+    }
+
+    for (const BookMove& move : moves)
+    {
+        std::cout << Chess::moveToString(move.move) << "\t" << move.weight << "\t"
+            << (total ? 100.0 * move.weight / total : 0) << "%" << std::endl;
+    }
+
+    if (moves.empty())
+    {
+        std::cout << "not in the book" << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+// the FEN from argument first on, split by the shell at its spaces; the start when there is none
+static std::string fenArgument(int argc, char* argv[], int first)
+{
+    std::string fen = argc <= first ? START_FEN : argv[first];
+    for (int i = first + 1; i < argc; ++i)
+    {
+        fen += ' ';
+        fen += argv[i];
+    }
+
+    return fen;
+}
+
+int main(int argc, char* argv[])
+{
+    std::string command = argc > 1 ? argv[1] : "";
+
+    if (command == "convert" || command == "index" || command == "book")
+    {
+        BookBuildOptions options;
+        options.threads = std::max(1u, std::thread::hardware_concurrency());
+        std::vector<std::string> files;
+
+        for (int i = 2; i < argc; ++i)
+        {
+            if (std::strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+            {
+                options.threads = std::max(1, std::atoi(argv[++i]));
+            }
+
+            else if (std::strcmp(argv[i], "-p") == 0 && i + 1 < argc)
+            {
+                options.max_ply = std::max(1, std::atoi(argv[++i]));
+            }
+
+            else if (std::strcmp(argv[i], "-m") == 0 && i + 1 < argc)
+            {
+                options.memory_mb = std::max(1, std::atoi(argv[++i]));
+            }
+
+            else if (std::strcmp(argv[i], "-g") == 0 && i + 1 < argc)
+            {
+                options.min_games = std::max(1, std::atoi(argv[++i]));
+            }
+
+            else
+            {
+                files.push_back(argv[i]);
+            }
+        }
+
+        if (command == "index" && files.size() == 2)
+        {
+            return index(files[0], files[1], options.threads, options.memory_mb);
+        }
+
+        if (command == "book" && files.size() == 2)
+        {
+            return book(files[0], files[1], options);
+        }
+
+        if (command == "convert" && files.size() >= 2)
+        {
+            std::string out = files.front();
+            files.erase(files.begin());
+            return convert(out, files, options.threads);
+        }
+    }
+
+    if (command == "info" && argc == 3)
+    {
+        return info(argv[2]);
+    }
+
+    if (command == "show" && argc == 4)
+    {
+        return show(argv[2], std::strtoull(argv[3], nullptr, 10));
+    }
+
+    if (command == "find" && argc >= 3)
+    {
+        return find(argv[2], fenArgument(argc, argv, 3));
+    }
+
+    if (command == "probe" && argc >= 3)
+    {
+        return probe(argv[2], fenArgument(argc, argv, 3));
+    }
+
+    usage();
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,101 @@
+#ifndef GAMEDB_H
+#define GAMEDB_H
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "chess.h"
+#include "mappedfile.h"
+
+enum class GameOutcome : std::uint8_t {
+    Unknown, WhiteWins, BlackWins, Draw
+};
+
+GameOutcome outcomeFromResult(std::string_view result); // "1-0", "0-1", "1/2-1/2", anything else is Unknown
+const char* resultString(GameOutcome outcome);
+
+// Binary game file, all integers little-endian:
+//   header   "CGDB", uint32 version, uint64 game count, uint64 index offset
+//   games    uint8 outcome, uint8 flags, uint16 plies, [uint16 length, FEN bytes
+//            when flags & 1], then plies moves in Move::pack's 16-bit encoding
+//   index    uint64 offset of every game, plus one past the last
+// A game from the standard start costs 4 bytes, 2 per move and 8 in the index.
+constexpr std::uint32_t GAMEDB_VERSION = 1;
+constexpr std::size_t GAMEDB_HEADER_SIZE = 24;
+constexpr int GAMEDB_MAX_PLIES = 65535;
+
+// one stored game, pointing into the mapped file
+struct GameRecord {
+    GameOutcome outcome;
+    std::string_view fen; // empty for the standard start
+    const unsigned char* moves;
+    int plies;
+
+    Move move(int ply) const;
+};
+
+// Appends games and writes the index when closed.
+class GameDbWriter {
+    private:
+        std::ofstream m_file;
+        std::vector<std::uint64_t> m_offsets;
+        std::uint64_t m_position;
+        std::string m_buffer;
+
+    public:
+        GameDbWriter();
+        ~GameDbWriter();
+
+        bool open(const std::string& path);
+        bool addGame(const std::vector<Move>& moves, GameOutcome outcome, const std::string& fen = ""); // false past 65535 plies
+        bool close(); // false if anything failed to write
+
+        std::size_t size() const;
+};
+
+// Read side: the file stays mapped, game(i) is a lookup in the index. Records
+// are checked against their index entries when read, so a damaged file gives
+// false rather than reads past the mapping.
+class GameDb {
+    private:
+        MappedFile m_file;
+        const unsigned char* m_index;
+        std::size_t m_size;
+
+    public:
+        GameDb();
+        ~GameDb() = default;
+
+        bool open(const std::string& path); // false when missing or not a valid game file
+
+        std::size_t size() const;
+        bool game(std::size_t index, GameRecord& game) const; // false when the record is damaged
+};
+
+// Plays a stored game move by move on a Chess. Each move is checked with
+// isLegalMove before doMove, so a damaged record stops the replay early and
+// leaves damaged() set instead of corrupting the position.
+class GameReplay {
+    private:
+        Chess& m_position;
+        GameRecord m_game;
+        int m_ply;
+        Move m_next;
+        bool m_damaged;
+
+        void prepare(); // checks the move at m_ply into m_next
+
+    public:
+        GameReplay(const GameRecord& game, Chess& position); // sets up the starting position
+        ~GameReplay() = default;
+
+        bool next(); // plays the next move, false once the game is over or damaged
+        Move nextMove() const; // NO_MOVE at the end
+        int ply() const;
+        bool damaged() const; // a bad FEN or an illegal move was found
+};
+
+#endif
@@ -0,0 +1,118 @@
+#include <fstream>
+#include "mappedfile.h"
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile() : m_data(nullptr), m_size(0), m_mapping(nullptr) {}
+
+MappedFile::~MappedFile()
+{
+    release();
+}
+
+void MappedFile::release()
+{
+#ifdef __linux__
+    if (m_mapping)
+    {
+        munmap(m_mapping, m_size);
+    }
+#endif
+
+    m_data = nullptr;
+    m_size = 0;
+    m_mapping = nullptr;
+    m_owned.clear();
+}
+
+void MappedFile::close()
+{
+    release();
+}
+
+bool MappedFile::open(const std::string& path, bool sequential)
+{
+    release();
+
+#ifdef __linux__
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    std::size_t size = static_cast<std::size_t>(info.st_size);
+    void* mapping = size ? mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) : nullptr;
+    ::close(fd);
+
+    if (mapping == MAP_FAILED)
+    {
+        return false;
+    }
+
+    if (mapping && sequential)
+    {
+        madvise(mapping, size, MADV_SEQUENTIAL);
+    }
+
+    m_mapping = mapping;
+    m_data = static_cast<const char*>(mapping);
+    m_size = size;
+#else
+    (void)sequential;
+
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file)
+    {
+        return false;
+    }
+
+    m_owned.resize(static_cast<std::size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(m_owned.data(), m_owned.size());
+
+    m_data = m_owned.data();
+    m_size = m_owned.size();
+#endif
+
+    // an empty file is open with nothing in it
+    static const char empty = 0;
+    if (!m_data)
+    {
+        m_data = &empty;
+    }
+
+    return true;
+}
+
+bool MappedFile::isOpen() const
+{
+    return m_data != nullptr;
+}
+
+const char* MappedFile::data() const
+{
+    return m_data;
+}
+
+std::size_t MappedFile::size() const
+{
+    return m_size;
+}
+
+std::string_view MappedFile::view() const
+{
+    return std::string_view(m_data ? m_data : "", m_size);
+}
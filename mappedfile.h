@@ -0,0 +1,38 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A whole file mapped read-only, for the tools that scan files of several
+// gigabytes: pages come straight from the page cache and nothing is copied.
+// Off Linux the file is read into memory instead.
+class MappedFile {
+    private:
+        const char* m_data;
+        std::size_t m_size;
+        void* m_mapping;
+        std::vector<char> m_owned; // the contents when not mapped
+
+        void release();
+
+    public:
+        MappedFile();
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        // sequential tells the kernel the file is read front to back once, so it reads ahead further
+        bool open(const std::string& path, bool sequential = false);
+        void close();
+
+        bool isOpen() const;
+        const char* data() const;
+        std::size_t size() const;
+        std::string_view view() const;
+};
+
+#endif
@@ -0,0 +1,392 @@
+#include <iostream>
+#include "chess.h"
+
+static void addMoves(MoveList& moves, int from, Bitboard targets, MoveType type)
+{
+    while (targets)
+    {
+        int to = popLsb(targets);
+        moves.push({static_cast<std::uint8_t>(from), static_cast<std::uint8_t>(to), type, FigureType::Queen});
+    }
+}
+
+static void addPromotions(MoveList& moves, int from, int to)
+{
+    const FigureType promotions[] = {FigureType::Queen, FigureType::Rook, FigureType::Bishop, FigureType::Knight};
+
+    for (FigureType type : promotions)
+    {
+        moves.push({static_cast<std::uint8_t>(from), static_cast<std::uint8_t>(to), MoveType::Promote, type});
+    }
+}
+
+// targets are the squares a move may land on; a pinned pawn is further kept to the
+// line through its king, en passant is checked on its own. Promotions count as
+// captures, so the quiet stage never holds them.
+void Chess::generatePawnMoves(MoveList& moves, GenType gen, Bitboard targets, Bitboard pinned) const
+{
+    int us = static_cast<int>(m_player_turn);
+    int push = (us == 0) ? 8 : -8;
+    int start_rank = (us == 0) ? 1 : 6;
+    int last_rank = (us == 0) ? 7 : 0;
+    int king = kingSquare(us);
+
+    bool quiets = gen != GenType::Captures;
+    bool captures = gen != GenType::Quiets;
+
+    Bitboard enemy = m_board.occupancy[1 - us];
+    int en_passant = m_en_passant;
+
+    Bitboard pawns = m_board.pieces[us][static_cast<int>(FigureType::Pawn)];
+    while (pawns)
+    {
+        int from = popLsb(pawns);
+        int to = from + push;
+
+        Bitboard allowed = targets;
+        if (pinned & squareBit(from))
+        {
+            allowed &= line(king, from);
+        }
+
+        if (!(m_board.all & squareBit(to)))
+        {
+            if (squareBit(to) & allowed)
+            {
+                if (rankOf(to) == last_rank)
+                {
+                    if (captures)
+                    {
+                        addPromotions(moves, from, to);
+                    }
+                }
+
+                else if (quiets)
+                {
+                    addMoves(moves, from, squareBit(to), MoveType::None);
+                }
+            }
+
+            if (quiets && rankOf(from) == start_rank && !(m_board.all & squareBit(to + push)))
+            {
+                addMoves(moves, from, squareBit(to + push) & allowed, MoveType::None);
+            }
+        }
+
+        if (!captures)
+        {
+            continue;
+        }
+
+        Bitboard attacks = pawnAttacks(us, from) & enemy & allowed;
+        while (attacks)
+        {
+            to = popLsb(attacks);
+
+            if (rankOf(to) == last_rank)
+            {
+                addPromotions(moves, from, to);
+            }
+
+            else
+            {
+                addMoves(moves, from, squareBit(to), MoveType::None);
+            }
+        }
+
+        if (en_passant != NO_SQUARE && (pawnAttacks(us, from) & squareBit(en_passant)) && isLegalEnPassant(from))
+        {
+            addMoves(moves, from, squareBit(en_passant), MoveType::Passant);
+        }
+    }
+}
+
+// knights and sliders of one type
+void Chess::generatePieceMoves(MoveList& moves, int type, Bitboard targets, Bitboard pinned) const
+{
+    int us = static_cast<int>(m_player_turn);
+    int king = kingSquare(us);
+
+    Bitboard pieces = m_board.pieces[us][type];
+    while (pieces)
+    {
+        int from = popLsb(pieces);
+        Bitboard attacks = 0;
+
+        switch (static_cast<FigureType>(type))
+        {
+            case FigureType::Knight: attacks = knightAttacks(from); break;
+            case FigureType::Bishop: attacks = bishopAttacks(from, m_board.all); break;
+            case FigureType::Rook: attacks = rookAttacks(from, m_board.all); break;
+            case FigureType::Queen: attacks = queenAttacks(from, m_board.all); break;
+            default: break;
+        }
+
+        if (pinned & squareBit(from))
+        {
+            attacks &= line(king, from);
+        }
+
+        addMoves(moves, from, attacks & targets, MoveType::None);
+    }
+}
+
+// the king is lifted off the board first, so it cannot hide behind itself from a slider
+void Chess::generateKingMoves(MoveList& moves, Bitboard targets) const
+{
+    int us = static_cast<int>(m_player_turn);
+    int king = kingSquare(us);
+    Bitboard occupied = m_board.all ^ squareBit(king);
+
+    targets &= kingAttacks(king);
+    while (targets)
+    {
+        int to = popLsb(targets);
+
+        if (!(attackersTo(to, occupied) & m_board.occupancy[1 - us]))
+        {
+            addMoves(moves, king, squareBit(to), MoveType::None);
+        }
+    }
+}
+
+void Chess::generateCastles(MoveList& moves) const
+{
+    int us = static_cast<int>(m_player_turn);
+    int king = (us == 0) ? 4 : 60;
+    int rights = m_castle_rights >> (2 * us);
+
+    if (!(rights & (WhiteKingSide | WhiteQueenSide)) || !isCheck(toPoint(king)))
+    {
+        return;
+    }
+
+    if ((rights & WhiteKingSide) && !(between(king, king + 3) & m_board.all) &&
+            isCheck(toPoint(king + 1)) && isCheck(toPoint(king + 2)))
+    {
+        addMoves(moves, king, squareBit(king + 2), MoveType::CastleRight);
+    }
+
+    if ((rights & WhiteQueenSide) && !(between(king, king - 4) & m_board.all) &&
+            isCheck(toPoint(king - 1)) && isCheck(toPoint(king - 2)))
+    {
+        addMoves(moves, king, squareBit(king - 2), MoveType::CastleLeft);
+    }
+}
+
+// en passant removes two pawns from one rank at once, which can uncover the king
+// in ways the pin test does not see, so the resulting occupancy is tested as a whole
+bool Chess::isLegalEnPassant(int from) const
+{
+    int us = static_cast<int>(m_player_turn);
+    int captured = m_en_passant + ((us == 0) ? -8 : 8);
+    Bitboard occupied = (m_board.all ^ squareBit(from) ^ squareBit(captured)) | squareBit(m_en_passant);
+
+    return !(attackersTo(kingSquare(us), occupied) & m_board.occupancy[1 - us] & ~squareBit(captured));
+}
+
+// squares the moves of one generation stage may land on, before check evasion
+Bitboard Chess::genTargets(GenType gen) const
+{
+    int us = static_cast<int>(m_player_turn);
+
+    switch (gen)
+    {
+        case GenType::Captures:
+            return m_board.occupancy[1 - us];
+
+        case GenType::Quiets:
+            return ~m_board.all;
+
+        default:
+            return ~m_board.occupancy[us];
+    }
+}
+
+// Legal moves straight from the checkers and pins of the position: in check only
+// evasions are generated, pinned pieces stay on their pin ray and king moves are
+// tested against the attacks they walk into. No move is played to test it.
+// gen picks captures and promotions, the other moves, or both.
+void Chess::generateMoves(MoveList& moves, GenType gen) const
+{
+    int us = static_cast<int>(m_player_turn);
+    int king = kingSquare(us);
+    Bitboard checking = checkers();
+    Bitboard targets = genTargets(gen);
+
+    moves.clear();
+    generateKingMoves(moves, targets);
+
+    // in double check only the king can move
+    if (moreThanOne(checking))
+    {
+        return;
+    }
+
+    Bitboard evasion = ~Bitboard(0);
+    if (checking)
+    {
+        evasion = between(king, lsb(checking)) | checking;
+    }
+
+    Bitboard pinned = pinnedPieces(us);
+
+    generatePawnMoves(moves, gen, evasion, pinned);
+    generatePieceMoves(moves, static_cast<int>(FigureType::Knight), targets & evasion, pinned);
+    generatePieceMoves(moves, static_cast<int>(FigureType::Bishop), targets & evasion, pinned);
+    generatePieceMoves(moves, static_cast<int>(FigureType::Rook), targets & evasion, pinned);
+    generatePieceMoves(moves, static_cast<int>(FigureType::Queen), targets & evasion, pinned);
+
+    if (!checking && gen != GenType::Captures)
+    {
+        generateCastles(moves);
+    }
+}
+
+// Whether a move from somewhere else (hash table, killer slot) can be played here:
+// only the moving piece's legal moves to its target square are generated and
+// searched for it (en passant and castling do not depend on the targets).
+bool Chess::isLegalMove(const Move& move) const
+{
+    int us = static_cast<int>(m_player_turn);
+    int type = pieceTypeOn(move.from);
+
+    if (type == NO_PIECE || !(m_board.occupancy[us] & squareBit(move.from)))
+    {
+        return false;
+    }
+
+    int king = kingSquare(us);
+    Bitboard checking = checkers();
+    Bitboard targets = ~m_board.occupancy[us] & squareBit(move.to);
+
+    MoveList moves;
+
+    if (type == static_cast<int>(FigureType::King))
+    {
+        generateKingMoves(moves, targets);
+
+        if (!checking)
+        {
+            generateCastles(moves);
+        }
+    }
+
+    else if (!moreThanOne(checking))
+    {
+        if (checking)
+        {
+            targets &= between(king, lsb(checking)) | checking;
+        }
+
+        if (type == static_cast<int>(FigureType::Pawn))
+        {
+            generatePawnMoves(moves, GenType::All, targets, pinnedPieces(us));
+        }
+
+        else
+        {
+            generatePieceMoves(moves, type, targets, pinnedPieces(us));
+        }
+    }
+
+    for (const Move& legal : moves)
+    {
+        if (legal == move)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// generateMoves one piece type at a time, stopping at the first type that has a
+// move; castling is left out since the king can then also step to the square it crosses
+bool Chess::hasLegalMove() const
+{
+    int us = static_cast<int>(m_player_turn);
+    int king = kingSquare(us);
+    Bitboard checking = checkers();
+
+    Bitboard targets = ~m_board.occupancy[us];
+
+    MoveList moves;
+    generateKingMoves(moves, targets);
+
+    if (moves.size() || moreThanOne(checking))
+    {
+        return moves.size();
+    }
+
+    if (checking)
+    {
+        targets &= between(king, lsb(checking)) | checking;
+    }
+
+    Bitboard pinned = pinnedPieces(us);
+
+    generatePawnMoves(moves, GenType::All, targets, pinned);
+
+    const FigureType types[] = {FigureType::Knight, FigureType::Bishop, FigureType::Rook, FigureType::Queen};
+    for (FigureType type : types)
+    {
+        if (moves.size())
+        {
+            return true;
+        }
+
+        generatePieceMoves(moves, static_cast<int>(type), targets, pinned);
+    }
+
+    return moves.size();
+}
+
+// walks the legal move tree through the same doMove/undoMove path makeMove uses
+std::uint64_t Chess::perft(int depth)
+{
+    if (depth == 0)
+    {
+        return 1;
+    }
+
+    MoveList moves;
+    generateMoves(moves);
+
+    if (depth == 1)
+    {
+        return moves.size();
+    }
+
+    std::uint64_t nodes = 0;
+
+    for (const Move& move : moves)
+    {
+        doMove(move);
+        nodes += perft(depth - 1);
+        undoMove();
+    }
+
+    return nodes;
+}
+
+// perft with a node count printed for every root move
+std::uint64_t Chess::divide(int depth)
+{
+    MoveList moves;
+    generateMoves(moves);
+
+    std::uint64_t nodes = 0;
+
+    for (const Move& move : moves)
+    {
+        doMove(move);
+        std::uint64_t count = perft(depth - 1);
+        undoMove();
+
+        std::cout << moveToString(move) << ": " << count << std::endl;
+        nodes += count;
+    }
+
+    return nodes;
+}
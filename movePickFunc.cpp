@@ -0,0 +1,200 @@
+#include <utility>
+#include "movepick.h"
+
+MovePicker::MovePicker(const Chess& position, const Move& tt_move, const Move* killers, const Move& counter_move,
+    const HistoryTable* history) :
+    m_position(position), m_history(history), m_tt_move(tt_move), m_killers{killers[0], killers[1]},
+    m_counter_move(counter_move), m_captures_only(false), m_stage(Stage::TTMove), m_index(0), m_bad_index(0) {}
+
+MovePicker::MovePicker(const Chess& position, bool captures_only) :
+    m_position(position), m_history(nullptr), m_tt_move(NO_MOVE), m_killers{NO_MOVE, NO_MOVE},
+    m_counter_move(NO_MOVE), m_captures_only(captures_only), m_stage(Stage::GenCaptures), m_index(0), m_bad_index(0) {}
+
+bool MovePicker::isSpecial(const Move& move) const
+{
+    return move == m_tt_move || move == m_killers[0] || move == m_killers[1] || move == m_counter_move;
+}
+
+// killers and counter moves were quiet where they were found, here they must
+// still be quiet and legal
+bool MovePicker::isUsableQuiet(const Move& move) const
+{
+    return move != NO_MOVE && move != m_tt_move && move.type != MoveType::Promote &&
+            !m_position.isCapture(move) && m_position.isLegalMove(move);
+}
+
+// most valuable victim first, least valuable attacker among equal victims
+void MovePicker::scoreCaptures()
+{
+    for (int i = 0; i < m_moves.size(); ++i)
+    {
+        const Move& move = m_moves[i];
+
+        int victim = move.type == MoveType::Passant ? static_cast<int>(FigureType::Pawn) : m_position.pieceTypeOn(move.to);
+        int attacker = m_position.pieceTypeOn(move.from);
+
+        m_scores[i] = (victim == NO_PIECE ? 0 : 100 * piece_value[victim]) - piece_value[attacker];
+
+        if (move.type == MoveType::Promote)
+        {
+            m_scores[i] += 100 * piece_value[static_cast<int>(move.promote)];
+        }
+    }
+}
+
+void MovePicker::scoreQuiets()
+{
+    int us = static_cast<int>(m_position.getPlayerType());
+
+    for (int i = 0; i < m_moves.size(); ++i)
+    {
+        m_scores[i] = m_history ? (*m_history)[us][m_moves[i].from][m_moves[i].to] : 0;
+    }
+
+    // insertion sort, most quiet lists get searched deep into anyway
+    for (int i = 1; i < m_moves.size(); ++i)
+    {
+        Move move = m_moves[i];
+        int score = m_scores[i];
+        int j = i - 1;
+
+        while (j >= 0 && m_scores[j] < score)
+        {
+            m_moves[j + 1] = m_moves[j];
+            m_scores[j + 1] = m_scores[j];
+            --j;
+        }
+
+        m_moves[j + 1] = move;
+        m_scores[j + 1] = score;
+    }
+}
+
+Move MovePicker::next()
+{
+    switch (m_stage)
+    {
+        case Stage::TTMove:
+            m_stage = Stage::GenCaptures;
+
+            if (m_tt_move != NO_MOVE && m_position.isLegalMove(m_tt_move))
+            {
+                return m_tt_move;
+            }
+
+            m_tt_move = NO_MOVE;
+            [[fallthrough]];
+
+        case Stage::GenCaptures:
+            m_position.generateMoves(m_moves, GenType::Captures);
+            scoreCaptures();
+            m_index = 0;
+            m_stage = Stage::Captures;
+            [[fallthrough]];
+
+        case Stage::Captures:
+            // selection of the best remaining capture, the tail is never sorted if a cut comes first
+            while (m_index < m_moves.size())
+            {
+                int best = m_index;
+                for (int i = m_index + 1; i < m_moves.size(); ++i)
+                {
+                    if (m_scores[i] > m_scores[best])
+                    {
+                        best = i;
+                    }
+                }
+
+                std::swap(m_moves[m_index], m_moves[best]);
+                std::swap(m_scores[m_index], m_scores[best]);
+
+                const Move& move = m_moves[m_index++];
+                if (move == m_tt_move)
+                {
+                    continue;
+                }
+
+                if (move.type != MoveType::Promote && m_position.see(move) < 0)
+                {
+                    m_bad_captures.push(move);
+                    continue;
+                }
+
+                return move;
+            }
+
+            // quiescence drops the losing captures altogether
+            if (m_captures_only)
+            {
+                m_stage = Stage::Done;
+                return NO_MOVE;
+            }
+
+            m_stage = Stage::Killer1;
+            [[fallthrough]];
+
+        case Stage::Killer1:
+            m_stage = Stage::Killer2;
+
+            if (isUsableQuiet(m_killers[0]))
+            {
+                return m_killers[0];
+            }
+
+            [[fallthrough]];
+
+        case Stage::Killer2:
+            m_stage = Stage::CounterMove;
+
+            if (m_killers[1] != m_killers[0] && isUsableQuiet(m_killers[1]))
+            {
+                return m_killers[1];
+            }
+
+            [[fallthrough]];
+
+        case Stage::CounterMove:
+            m_stage = Stage::GenQuiets;
+
+            if (m_counter_move != m_killers[0] && m_counter_move != m_killers[1] && isUsableQuiet(m_counter_move))
+            {
+                return m_counter_move;
+            }
+
+            [[fallthrough]];
+
+        case Stage::GenQuiets:
+            m_position.generateMoves(m_moves, GenType::Quiets);
+            scoreQuiets();
+            m_index = 0;
+            m_stage = Stage::Quiets;
+            [[fallthrough]];
+
+        case Stage::Quiets:
+            while (m_index < m_moves.size())
+            {
+                const Move& move = m_moves[m_index++];
+                if (!isSpecial(move))
+                {
+                    return move;
+                }
+            }
+
+            m_stage = Stage::BadCaptures;
+            [[fallthrough]];
+
+        case Stage::BadCaptures:
+            if (m_bad_index < m_bad_captures.size())
+            {
+                return m_bad_captures[m_bad_index++];
+            }
+
+            m_stage = Stage::Done;
+            [[fallthrough]];
+
+        case Stage::Done:
+            break;
+    }
+
+    return NO_MOVE;
+}
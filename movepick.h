@@ -0,0 +1,55 @@
+#ifndef MOVEPICK_H
+#define MOVEPICK_H
+
+#include "chess.h"
+
+// quiet move history, [FigureColor][from][to]
+using HistoryTable = int[2][SQUARE_NB][SQUARE_NB];
+
+constexpr int HISTORY_MAX = 16384;
+
+// Hands out the moves of a node one at a time in the order they are most likely
+// to cut: hash move, captures by MVV-LVA, killers, counter move, the other quiet
+// moves by history, and last the captures that lose material by SEE. Each stage
+// is generated only when reached, and captures are picked best-first instead of
+// sorted, so a cutoff early on skips the rest.
+class MovePicker {
+    private:
+        enum class Stage : std::uint8_t {
+            TTMove, GenCaptures, Captures, Killer1, Killer2, CounterMove, GenQuiets, Quiets, BadCaptures, Done
+        };
+
+        const Chess& m_position;
+        const HistoryTable* m_history;
+
+        Move m_tt_move;
+        Move m_killers[2];
+        Move m_counter_move;
+        bool m_captures_only;
+
+        Stage m_stage;
+        MoveList m_moves;
+        int m_scores[MAX_MOVES];
+        int m_index;
+
+        MoveList m_bad_captures; // losing exchanges by SEE, tried after the quiet moves
+        int m_bad_index;
+
+        bool isSpecial(const Move& move) const; // already handed out by an earlier stage
+        bool isUsableQuiet(const Move& move) const;
+
+        void scoreCaptures();
+        void scoreQuiets();
+
+    public:
+        // main search; killers point at two slots, history may be nullptr
+        MovePicker(const Chess& position, const Move& tt_move, const Move* killers, const Move& counter_move,
+            const HistoryTable* history);
+
+        // quiescence: captures and promotions that do not lose material, or every evasion when in check
+        MovePicker(const Chess& position, bool captures_only);
+
+        Move next(); // NO_MOVE once every move was handed out
+};
+
+#endif
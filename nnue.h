@@ -0,0 +1,84 @@
+#ifndef NNUE_H
+#define NNUE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "bitboard.h"
+#include "mappedfile.h"
+
+// 768 inputs (colour relative to the perspective, type, square) into one hidden
+// layer per side to move, then a single output
+constexpr int NNUE_INPUTS = 768;
+constexpr int NNUE_HIDDEN = 256;
+
+// hidden layer sums for both perspectives, [FigureColor][neuron]
+struct alignas(32) Accumulator {
+    std::int16_t values[2][NNUE_HIDDEN];
+};
+
+enum class SimdLevel : std::uint8_t {
+    Scalar, Sse41, Avx2
+};
+
+// Efficiently updatable network: a piece appearing or leaving only adds or
+// subtracts one weight column per perspective, so Chess keeps an Accumulator
+// up to date from putPiece/removePiece/shiftPiece and evaluation is just the
+// output layer. Weights are memory-mapped straight from the file.
+//
+// file: "NNUE", uint32 version, uint32 inputs, uint32 hidden, then little-endian
+// int16 feature_bias[hidden], int16 feature_weights[inputs][hidden],
+// int16 output_weights[2 * hidden], int32 output_bias
+class Network {
+    private:
+        struct Kernels {
+            void (*add)(std::int16_t* acc, const std::int16_t* weights);
+            void (*sub)(std::int16_t* acc, const std::int16_t* weights);
+            void (*addSub)(std::int16_t* acc, const std::int16_t* add, const std::int16_t* sub);
+            int (*output)(const std::int16_t* us, const std::int16_t* them, const std::int16_t* weights);
+        };
+
+        MappedFile m_file;
+        std::vector<std::int16_t> m_owned; // weights not backed by a file
+
+        const std::int16_t* m_feature_bias;
+        const std::int16_t* m_feature_weights;
+        const std::int16_t* m_output_weights;
+        std::int32_t m_output_bias;
+
+        SimdLevel m_level;
+        Kernels m_kernels;
+
+        static int featureIndex(int perspective, int color, int type, int square);
+
+        const std::int16_t* column(int perspective, int color, int type, int square) const;
+
+        void release();
+
+    public:
+        Network();
+        ~Network() = default;
+
+        Network(const Network&) = delete;
+        Network& operator=(const Network&) = delete;
+
+        bool load(const std::string& path); // on failure the network is left empty
+        void randomize(std::uint64_t seed); // untrained weights, for benchmarks without a file
+        bool isLoaded() const;
+
+        static SimdLevel bestSupported();
+        static bool isSupported(SimdLevel level);
+        static const char* levelName(SimdLevel level);
+
+        bool setSimdLevel(SimdLevel level); // false if the CPU lacks it
+        SimdLevel getSimdLevel() const;
+
+        void refresh(Accumulator& acc, const Bitboard (&pieces)[2][6]) const;
+        void addPiece(Accumulator& acc, int color, int type, int square) const;
+        void removePiece(Accumulator& acc, int color, int type, int square) const;
+        void movePiece(Accumulator& acc, int color, int type, int from, int to) const;
+
+        int evaluate(const Accumulator& acc, int side_to_move) const; // centipawns
+};
+
+#endif
@@ -0,0 +1,380 @@
+#include <cstring>
+#include "nnue.h"
+#include "zobrist.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+constexpr std::uint32_t NNUE_VERSION = 1;
+constexpr std::size_t HEADER_SIZE = 16;
+constexpr std::size_t WEIGHTS_SIZE = sizeof(std::int16_t) * (NNUE_HIDDEN + NNUE_INPUTS * NNUE_HIDDEN + 2 * NNUE_HIDDEN) +
+        sizeof(std::int32_t);
+
+// quantization: hidden activations clipped to [0, QA], output weights scaled by QB
+constexpr int QA = 255;
+constexpr int QB = 64;
+constexpr int EVAL_SCALE = 400;
+
+static void addScalar(std::int16_t* acc, const std::int16_t* weights)
+{
+    for (int i = 0; i < NNUE_HIDDEN; ++i)
+    {
+        acc[i] += weights[i];
+    }
+}
+
+static void subScalar(std::int16_t* acc, const std::int16_t* weights)
+{
+    for (int i = 0; i < NNUE_HIDDEN; ++i)
+    {
+        acc[i] -= weights[i];
+    }
+}
+
+static void addSubScalar(std::int16_t* acc, const std::int16_t* add, const std::int16_t* sub)
+{
+    for (int i = 0; i < NNUE_HIDDEN; ++i)
+    {
+        acc[i] += add[i] - sub[i];
+    }
+}
+
+static int outputScalar(const std::int16_t* us, const std::int16_t* them, const std::int16_t* weights)
+{
+    int sum = 0;
+
+    for (int i = 0; i < NNUE_HIDDEN; ++i)
+    {
+        int a = us[i] < 0 ? 0 : (us[i] > QA ? QA : us[i]);
+        int b = them[i] < 0 ? 0 : (them[i] > QA ? QA : them[i]);
+        sum += a * weights[i] + b * weights[NNUE_HIDDEN + i];
+    }
+
+    return sum;
+}
+
+#if defined(__x86_64__)
+__attribute__((target("sse4.1"))) static void addSse41(std::int16_t* acc, const std::int16_t* weights)
+{
+    for (int i = 0; i < NNUE_HIDDEN; i += 8)
+    {
+        __m128i a = _mm_load_si128(reinterpret_cast<const __m128i*>(acc + i));
+        __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(weights + i));
+        _mm_store_si128(reinterpret_cast<__m128i*>(acc + i), _mm_add_epi16(a, w));
+    }
+}
+
+__attribute__((target("sse4.1"))) static void subSse41(std::int16_t* acc, const std::int16_t* weights)
+{
+    for (int i = 0; i < NNUE_HIDDEN; i += 8)
+    {
+        __m128i a = _mm_load_si128(reinterpret_cast<const __m128i*>(acc + i));
+        __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(weights + i));
+        _mm_store_si128(reinterpret_cast<__m128i*>(acc + i), _mm_sub_epi16(a, w));
+    }
+}
+
+__attribute__((target("sse4.1"))) static void addSubSse41(std::int16_t* acc, const std::int16_t* add, const std::int16_t* sub)
+{
+    for (int i = 0; i < NNUE_HIDDEN; i += 8)
+    {
+        __m128i a = _mm_load_si128(reinterpret_cast<const __m128i*>(acc + i));
+        __m128i w_add = _mm_loadu_si128(reinterpret_cast<const __m128i*>(add + i));
+        __m128i w_sub = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sub + i));
+        _mm_store_si128(reinterpret_cast<__m128i*>(acc + i), _mm_sub_epi16(_mm_add_epi16(a, w_add), w_sub));
+    }
+}
+
+__attribute__((target("sse4.1"))) static int outputSse41(const std::int16_t* us, const std::int16_t* them, const std::int16_t* weights)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i qa = _mm_set1_epi16(QA);
+    __m128i sum = _mm_setzero_si128();
+
+    for (int i = 0; i < NNUE_HIDDEN; i += 8)
+    {
+        __m128i a = _mm_min_epi16(_mm_max_epi16(_mm_load_si128(reinterpret_cast<const __m128i*>(us + i)), zero), qa);
+        __m128i b = _mm_min_epi16(_mm_max_epi16(_mm_load_si128(reinterpret_cast<const __m128i*>(them + i)), zero), qa);
+        __m128i w_a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(weights + i));
+        __m128i w_b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(weights + NNUE_HIDDEN + i));
+
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(a, w_a));
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(b, w_b));
+    }
+
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+    return _mm_cvtsi128_si32(sum);
+}
+
+__attribute__((target("avx2"))) static void addAvx2(std::int16_t* acc, const std::int16_t* weights)
+{
+    for (int i = 0; i < NNUE_HIDDEN; i += 16)
+    {
+        __m256i a = _mm256_load_si256(reinterpret_cast<const __m256i*>(acc + i));
+        __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights + i));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(acc + i), _mm256_add_epi16(a, w));
+    }
+}
+
+__attribute__((target("avx2"))) static void subAvx2(std::int16_t* acc, const std::int16_t* weights)
+{
+    for (int i = 0; i < NNUE_HIDDEN; i += 16)
+    {
+        __m256i a = _mm256_load_si256(reinterpret_cast<const __m256i*>(acc + i));
+        __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights + i));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(acc + i), _mm256_sub_epi16(a, w));
+    }
+}
+
+__attribute__((target("avx2"))) static void addSubAvx2(std::int16_t* acc, const std::int16_t* add, const std::int16_t* sub)
+{
+    for (int i = 0; i < NNUE_HIDDEN; i += 16)
+    {
+        __m256i a = _mm256_load_si256(reinterpret_cast<const __m256i*>(acc + i));
+        __m256i w_add = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(add + i));
+        __m256i w_sub = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(sub + i));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(acc + i), _mm256_sub_epi16(_mm256_add_epi16(a, w_add), w_sub));
+    }
+}
+
+__attribute__((target("avx2"))) static int outputAvx2(const std::int16_t* us, const std::int16_t* them, const std::int16_t* weights)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i qa = _mm256_set1_epi16(QA);
+    __m256i sum = _mm256_setzero_si256();
+
+    for (int i = 0; i < NNUE_HIDDEN; i += 16)
+    {
+        __m256i a = _mm256_min_epi16(_mm256_max_epi16(_mm256_load_si256(reinterpret_cast<const __m256i*>(us + i)), zero), qa);
+        __m256i b = _mm256_min_epi16(_mm256_max_epi16(_mm256_load_si256(reinterpret_cast<const __m256i*>(them + i)), zero), qa);
+        __m256i w_a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights + i));
+        __m256i w_b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights + NNUE_HIDDEN + i));
+
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(a, w_a));
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(b, w_b));
+    }
+
+    __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0x4E));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0xB1));
+    return _mm_cvtsi128_si32(half);
+}
+#endif
+
+Network::Network() : m_feature_bias(nullptr), m_feature_weights(nullptr), m_output_weights(nullptr),
+    m_output_bias(0), m_level(SimdLevel::Scalar), m_kernels()
+{
+    setSimdLevel(bestSupported());
+}
+
+void Network::release()
+{
+    m_file.close();
+    m_owned.clear();
+
+    m_feature_bias = nullptr;
+    m_feature_weights = nullptr;
+    m_output_weights = nullptr;
+    m_output_bias = 0;
+}
+
+// the file stays mapped read-only for as long as the network lives, so several
+// engines on one machine share a single copy of the weights in the page cache
+bool Network::load(const std::string& path)
+{
+    release();
+
+    if (!m_file.open(path))
+    {
+        return false;
+    }
+
+    const char* data = m_file.data();
+    std::uint32_t header[3] = {};
+
+    if (m_file.size() == HEADER_SIZE + WEIGHTS_SIZE && std::memcmp(data, "NNUE", 4) == 0)
+    {
+        std::memcpy(header, data + 4, sizeof(header));
+    }
+
+    if (header[0] != NNUE_VERSION || header[1] != NNUE_INPUTS || header[2] != NNUE_HIDDEN)
+    {
+        m_file.close();
+        return false;
+    }
+
+    const std::int16_t* weights = reinterpret_cast<const std::int16_t*>(data + HEADER_SIZE);
+    m_feature_bias = weights;
+    m_feature_weights = m_feature_bias + NNUE_HIDDEN;
+    m_output_weights = m_feature_weights + NNUE_INPUTS * NNUE_HIDDEN;
+    std::memcpy(&m_output_bias, m_output_weights + 2 * NNUE_HIDDEN, sizeof(m_output_bias));
+
+    return true;
+}
+
+// small weights so a full board stays well inside the int16 accumulator
+void Network::randomize(std::uint64_t seed)
+{
+    release();
+
+    m_owned.resize(NNUE_HIDDEN + NNUE_INPUTS * NNUE_HIDDEN + 2 * NNUE_HIDDEN);
+
+    for (std::int16_t& weight : m_owned)
+    {
+        weight = static_cast<std::int16_t>(static_cast<int>(splitMix64(seed) % 65) - 32);
+    }
+
+    m_feature_bias = m_owned.data();
+    m_feature_weights = m_feature_bias + NNUE_HIDDEN;
+    m_output_weights = m_feature_weights + NNUE_INPUTS * NNUE_HIDDEN;
+    m_output_bias = 0;
+}
+
+bool Network::isLoaded() const
+{
+    return m_feature_weights != nullptr;
+}
+
+SimdLevel Network::bestSupported()
+{
+    if (isSupported(SimdLevel::Avx2))
+    {
+        return SimdLevel::Avx2;
+    }
+
+    if (isSupported(SimdLevel::Sse41))
+    {
+        return SimdLevel::Sse41;
+    }
+
+    return SimdLevel::Scalar;
+}
+
+// the vector kernels are x86 only, elsewhere the scalar ones are all there is
+bool Network::isSupported(SimdLevel level)
+{
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+
+    switch (level)
+    {
+        case SimdLevel::Avx2:
+            return __builtin_cpu_supports("avx2");
+
+        case SimdLevel::Sse41:
+            return __builtin_cpu_supports("sse4.1");
+
+        default:
+            return true;
+    }
+#else
+    return level == SimdLevel::Scalar;
+#endif
+}
+
+const char* Network::levelName(SimdLevel level)
+{
+    switch (level)
+    {
+        case SimdLevel::Avx2:
+            return "avx2";
+
+        case SimdLevel::Sse41:
+            return "sse4.1";
+
+        default:
+            return "scalar";
+    }
+}
+
+bool Network::setSimdLevel(SimdLevel level)
+{
+    if (!isSupported(level))
+    {
+        return false;
+    }
+
+    m_kernels = {addScalar, subScalar, addSubScalar, outputScalar};
+
+#if defined(__x86_64__)
+    if (level == SimdLevel::Avx2)
+    {
+        m_kernels = {addAvx2, subAvx2, addSubAvx2, outputAvx2};
+    }
+
+    else if (level == SimdLevel::Sse41)
+    {
+        m_kernels = {addSse41, subSse41, addSubSse41, outputSse41};
+    }
+#endif
+
+    m_level = level;
+    return true;
+}
+
+SimdLevel Network::getSimdLevel() const
+{
+    return m_level;
+}
+
+// each side sees its own pieces as colour 0 and the board from its own back rank
+int Network::featureIndex(int perspective, int color, int type, int square)
+{
+    if (perspective == 1)
+    {
+        square ^= 56;
+    }
+
+    return ((color ^ perspective) * 6 + type) * SQUARE_NB + square;
+}
+
+const std::int16_t* Network::column(int perspective, int color, int type, int square) const
+{
+    return m_feature_weights + featureIndex(perspective, color, type, square) * NNUE_HIDDEN;
+}
+
+void Network::refresh(Accumulator& acc, const Bitboard (&pieces)[2][6]) const
+{
+    for (int perspective = 0; perspective < 2; ++perspective)
+    {
+        std::memcpy(acc.values[perspective], m_feature_bias, sizeof(acc.values[perspective]));
+    }
+
+    for (int color = 0; color < 2; ++color)
+    {
+        for (int type = 0; type < 6; ++type)
+        {
+            Bitboard b = pieces[color][type];
+            while (b)
+            {
+                addPiece(acc, color, type, popLsb(b));
+            }
+        }
+    }
+}
+
+void Network::addPiece(Accumulator& acc, int color, int type, int square) const
+{
+    m_kernels.add(acc.values[0], column(0, color, type, square));
+    m_kernels.add(acc.values[1], column(1, color, type, square));
+}
+
+void Network::removePiece(Accumulator& acc, int color, int type, int square) const
+{
+    m_kernels.sub(acc.values[0], column(0, color, type, square));
+    m_kernels.sub(acc.values[1], column(1, color, type, square));
+}
+
+void Network::movePiece(Accumulator& acc, int color, int type, int from, int to) const
+{
+    m_kernels.addSub(acc.values[0], column(0, color, type, to), column(0, color, type, from));
+    m_kernels.addSub(acc.values[1], column(1, color, type, to), column(1, color, type, from));
+}
+
+int Network::evaluate(const Accumulator& acc, int side_to_move) const
+{
+    int sum = m_kernels.output(acc.values[side_to_move], acc.values[1 - side_to_move], m_output_weights);
+    return static_cast<int>((static_cast<std::int64_t>(sum) + m_output_bias) * EVAL_SCALE / (QA * QB));
+}
@@ -0,0 +1,39 @@
+#ifndef PAWNS_H
+#define PAWNS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "evaluate.h"
+
+// everything the evaluation wants to know about one pawn structure
+struct PawnEntry {
+    std::uint64_t key; // pawn-only zobrist key
+    Score score; // passed, isolated, doubled and backward pawns, white minus black
+    Bitboard passed[2]; // [FigureColor]
+    Bitboard attacks[2]; // squares the pawns attack now
+    Bitboard attack_span[2]; // squares the pawns could attack by advancing
+};
+
+// Pawn structures repeat far more often than positions do, so their score is
+// cached by pawn key. One table per search thread, nothing is shared. A pawnless
+// position has key 0 and matches the zeroed entries, which is also its score.
+class PawnTable {
+    private:
+        std::vector<PawnEntry> m_entries; // power of two
+        std::uint64_t m_probes;
+        std::uint64_t m_hits;
+
+    public:
+        explicit PawnTable(std::size_t entries = 16384);
+        ~PawnTable() = default;
+
+        // the slot for key; true when it already holds that structure, else the caller fills it
+        bool probe(std::uint64_t key, PawnEntry*& entry);
+        void clear();
+
+        std::uint64_t probes() const;
+        std::uint64_t hits() const;
+};
+
+#endif
@@ -0,0 +1,43 @@
+#include "pawns.h"
+
+PawnTable::PawnTable(std::size_t entries) : m_probes(0), m_hits(0)
+{
+    std::size_t size = 1;
+    while (size * 2 <= entries)
+    {
+        size *= 2;
+    }
+
+    m_entries.assign(size, PawnEntry());
+}
+
+bool PawnTable::probe(std::uint64_t key, PawnEntry*& entry)
+{
+    entry = &m_entries[key & (m_entries.size() - 1)];
+
+    ++m_probes;
+    if (entry->key == key)
+    {
+        ++m_hits;
+        return true;
+    }
+
+    return false;
+}
+
+void PawnTable::clear()
+{
+    m_entries.assign(m_entries.size(), PawnEntry());
+    m_probes = 0;
+    m_hits = 0;
+}
+
+std::uint64_t PawnTable::probes() const
+{
+    return m_probes;
+}
+
+std::uint64_t PawnTable::hits() const
+{
+    return m_hits;
+}
@@ -0,0 +1,224 @@
+#include "chess.h"
+#include "timer.h"
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+
+struct PerftPosition {
+    const char* name;
+    const char* fen;
+    int depth;
+    std::uint64_t nodes;
+};
+
+// reference counts from the chess programming wiki perft results page
+static const PerftPosition positions[] = {
+    {"start", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 5, 4865609},
+    {"kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 4, 4085603},
+    {"position 3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 5, 674624},
+    {"position 4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 4, 422333},
+    {"position 5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 4, 2103487},
+    {"position 6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 4, 3894594}
+};
+
+struct FenCase {
+    const char* fen;
+    const char* expected; // what toFEN gives back, nullptr when the FEN must be refused
+};
+
+// positions the move generator cannot play from, and rights and en passant squares that do not hold
+static const FenCase fen_cases[] = {
+    {"r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1", "r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1"},
+    {"4k3/8/8/8/8/8/8/4K3 w K - 0 1", "4k3/8/8/8/8/8/8/4K3 w - - 0 1"},
+    {"4k3/8/8/8/8/8/8/6K1 w Q - 0 1", "4k3/8/8/8/8/8/8/6K1 w - - 0 1"},
+    {"r3k2r/8/8/8/8/8/8/R3K1R1 w KQkq - 0 1", "r3k2r/8/8/8/8/8/8/R3K1R1 w Qkq - 0 1"},
+    {"1r2k2r/8/8/8/8/8/8/R3K2R b KQkq - 0 1", "1r2k2r/8/8/8/8/8/8/R3K2R b KQk - 0 1"},
+    {"rnbqkbnr/ppp1pppp/8/8/3pP3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 3", "rnbqkbnr/ppp1pppp/8/8/3pP3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 3"},
+    {"4k3/8/8/8/8/8/2PP4/4K3 w - d3 0 1", "4k3/8/8/8/8/8/2PP4/4K3 w - - 0 1"},
+    {"4k3/8/8/2Pp4/8/8/8/4K3 w - d3 0 1", "4k3/8/8/2Pp4/8/8/8/4K3 w - - 0 1"},
+    {"4k3/8/8/2P5/8/8/8/4K3 w - d6 0 1", "4k3/8/8/2P5/8/8/8/4K3 w - - 0 1"},
+    {"P3k3/8/8/8/8/8/8/4K3 w - - 0 1", nullptr},
+    {"4k3/8/8/8/8/8/8/p3K3 w - - 0 1", nullptr},
+    {"4k3/8/8/8/8/8/4K3 w - - 0 1", nullptr},
+    {"4k3/8/8/8/8/8/8/8/4K3 w - - 0 1", nullptr},
+    {"4k4/8/8/8/8/8/8/4K3 w - - 0 1", nullptr},
+    {"4k2/8/8/8/8/8/8/4K3 w - - 0 1", nullptr},
+    {"4k3/8/8/8/8/8/8/4K2K w - - 0 1", nullptr},
+    {"8/8/8/8/8/8/8/4K3 w - - 0 1", nullptr},
+    {"4k3/8/8/8/8/8/8/4K2r b - - 0 1", nullptr},
+    {"4k3/8/8/8/8/8/8/4K3 x - - 0 1", nullptr},
+    {"4k3/8/8/8/8/8/8/4K3 w - -", "4k3/8/8/8/8/8/8/4K3 w - - 0 1"},
+    {"4k3/8/8/8/8/8/8/4K3 w - - 65535 40", "4k3/8/8/8/8/8/8/4K3 w - - 65535 40"},
+    {"4k3/8/8/8/8/8/8/4K3 w - - 65536 40", nullptr},
+    {"4k3/8/8/8/8/8/8/4K3 w - - -5 40", nullptr},
+    {"4k3/8/8/8/8/8/8/4K3 w - - 0 -1", nullptr},
+    {"4k3/8/8/8/8/8/8/4K3 w - - 0 1x", nullptr},
+    {"4k3/8/8/8/8/8/8/4K3 w - - +3 1", nullptr},
+    {"4k3/8/8/8/8/8/8/4K3 w - - 0 99999999999", nullptr}
+};
+
+struct PolyglotCase {
+    const char* moves; // from the start
+    std::uint64_t key;
+};
+
+// the test positions published with the Polyglot book format, en passant and castling included
+static const PolyglotCase polyglot_cases[] = {
+    {"", 0x463B96181691FC9CULL},
+    {"e2e4", 0x823C9B50FD114196ULL},
+    {"e2e4 d7d5", 0x0756B94461C50FB0ULL},
+    {"e2e4 d7d5 e4e5", 0x662FAFB965DB29D4ULL},
+    {"e2e4 d7d5 e4e5 f7f5", 0x22A48B5A8E47FF78ULL},
+    {"e2e4 d7d5 e4e5 f7f5 e1e2", 0x652A607CA3F242C1ULL},
+    {"e2e4 d7d5 e4e5 f7f5 e1e2 e8f7", 0x00FDD303C946BDD9ULL},
+    {"a2a4 b7b5 h2h4 b5b4 c2c4", 0x3C8123EA7B067637ULL},
+    {"a2a4 b7b5 h2h4 b5b4 c2c4 b4c3 a1a3", 0x5C3F9B829B279560ULL}
+};
+
+static void usage()
+{
+    std::cout << "usage: perft                         reference positions, FEN and book key checks" << std::endl;
+    std::cout << "       perft <depth> [fen]           count leaf nodes" << std::endl;
+    std::cout << "       perft divide <depth> [fen]    count leaf nodes below every root move" << std::endl;
+}
+
+static void report(std::uint64_t nodes, double time)
+{
+    std::cout << "nodes " << nodes << "  time " << time << "s  nps " 
+        << static_cast<std::uint64_t>(nodes / (time > 0 ? time : 1e-9)) << std::endl;
+}
+
+static int checkFens()
+{
+    int failed = 0;
+
+    for (const FenCase& test : fen_cases)
+    {
+        Chess game;
+        bool loaded = game.fromFEN(test.fen);
+        bool ok = test.expected ? loaded && game.toFEN() == test.expected : !loaded;
+
+        if (!ok)
+        {
+            std::cout << "FAIL  fen " << test.fen << " gave " << (loaded ? game.toFEN() : "nothing") << std::endl;
+            ++failed;
+        }
+    }
+
+    std::cout << (failed ? "FAIL  " : "ok    ") << "fen checks " << sizeof(fen_cases) / sizeof(fen_cases[0])
+        << std::endl;
+
+    return failed;
+}
+
+static int checkPolyglotKeys()
+{
+    int failed = 0;
+
+    for (const PolyglotCase& test : polyglot_cases)
+    {
+        Chess game;
+        std::istringstream moves(test.moves);
+        std::string move;
+
+        while (moves >> move)
+        {
+            game.tryMove(move);
+        }
+
+        if (game.polyglotKey() != test.key)
+        {
+            std::cout << "FAIL  polyglot key after \"" << test.moves << "\" is " << std::hex << game.polyglotKey()
+                << " expected " << test.key << std::dec << std::endl;
+            ++failed;
+        }
+    }
+
+    std::cout << (failed ? "FAIL  " : "ok    ") << "polyglot keys " << sizeof(polyglot_cases) / sizeof(polyglot_cases[0])
+        << std::endl;
+
+    return failed;
+}
+
+static int runSuite()
+{
+    int failed = checkFens() + checkPolyglotKeys();
+    std::uint64_t total_nodes = 0;
+    double total_time = 0;
+
+    for (const PerftPosition& position : positions)
+    {
+        Chess game;
+        game.fromFEN(position.fen);
+
+        auto start = std::chrono::steady_clock::now();
+        std::uint64_t nodes = game.perft(position.depth);
+        double time = seconds(start);
+
+        bool ok = nodes == position.nodes;
+        failed += !ok;
+        total_nodes += nodes;
+        total_time += time;
+
+        std::cout << (ok ? "ok    " : "FAIL  ") << position.name << " depth " << position.depth;
+        if (!ok)
+        {
+            std::cout << " expected " << position.nodes;
+        }
+        std::cout << "  ";
+        report(nodes, time);
+    }
+
+    std::cout << "total ";
+    report(total_nodes, total_time);
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc == 1)
+    {
+        return runSuite();
+    }
+
+    std::string command = argv[1];
+    bool divide = command == "divide";
+    int arg = divide ? 2 : 1;
+
+    if (arg >= argc)
+    {
+        usage();
+        return EXIT_FAILURE;
+    }
+
+    int depth = std::atoi(argv[arg]);
+
+    Chess game;
+    if (arg + 1 < argc && !game.fromFEN(argv[arg + 1]))
+    {
+        std::cout << "invalid FEN" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (depth < 1)
+    {
+        usage();
+        return EXIT_FAILURE;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::uint64_t nodes = divide ? game.divide(depth) : game.perft(depth);
+    double time = seconds(start);
+
+    if (divide)
+    {
+        std::cout << std::endl;
+    }
+
+    report(nodes, time);
+
+    return EXIT_SUCCESS;
+}
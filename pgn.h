@@ -0,0 +1,83 @@
+#ifndef PGN_H
+#define PGN_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "chess.h"
+
+// games split off a PGN text per batch, and batches split off but not handed
+// back yet; together they bound what the tools hold in memory
+constexpr std::size_t BATCH_GAMES = 16384;
+constexpr std::size_t QUEUED_BATCHES = 3;
+
+// what replaying one game found
+struct PgnCheck {
+    bool legal = true;
+    int plies = 0; // moves replayed before the end or the first bad one
+    std::string bad_move; // the SAN that was not a legal move, empty when legal
+    std::string result = "*"; // Result tag
+    std::string_view setup; // FEN tag, points into the game text, empty for the standard start
+    std::string fen; // position after the last legal move
+};
+
+// The next game in a PGN text starting at pos: its tag section and movetext,
+// ending where the following tag section starts. Nothing is copied, game points
+// into text. False once only whitespace is left.
+bool nextPgnGame(std::string_view text, std::size_t& pos, std::string_view& game);
+
+// Replays the movetext of one game through the legality checks, from the FEN tag
+// when there is one. position is scratch space, reused between games. The legal
+// moves are appended to moves when given.
+PgnCheck checkPgnGame(std::string_view game, Chess& position, std::vector<Move>* moves = nullptr);
+
+struct PgnGame {
+    PgnCheck check;
+    std::vector<Move> moves; // only filled when the pool keeps moves
+};
+
+// Replays PGN games on worker threads that live as long as the pool. The
+// calling thread splits batches off the text while the workers replay the
+// batches before it, and workers done with one batch go on with the next, so
+// neither the reading nor the slowest game of a batch holds the others up.
+// Results are handed back one batch at a time in input order.
+class PgnReplayPool {
+    private:
+        struct Batch {
+            std::vector<std::string_view> games;
+            std::vector<PgnGame> results;
+            std::size_t next = 0; // first game no worker took yet
+            std::size_t finished = 0;
+        };
+
+        bool m_keep_moves;
+        bool m_stop;
+        std::deque<std::unique_ptr<Batch>> m_batches; // in input order, the oldest first
+        std::vector<std::unique_ptr<Batch>> m_spare; // handed back, kept for their capacity
+        std::vector<std::thread> m_workers;
+        std::mutex m_mutex;
+        std::condition_variable m_work; // games queued or stopping
+        std::condition_variable m_finished; // a batch has been replayed
+
+        void work();
+        void handBack(const std::function<void(const std::vector<PgnGame>&)>& done);
+
+    public:
+        PgnReplayPool(int threads, bool keep_moves);
+        ~PgnReplayPool();
+
+        PgnReplayPool(const PgnReplayPool&) = delete;
+        PgnReplayPool& operator=(const PgnReplayPool&) = delete;
+
+        // every game of text, the results passed to done batch by batch before it returns
+        void replay(std::string_view text, const std::function<void(const std::vector<PgnGame>&)>& done);
+};
+
+#endif
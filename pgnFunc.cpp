@@ -0,0 +1,383 @@
+#include <algorithm>
+#include "pgn.h"
+
+static bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// the line starting at pos, without its line break
+static std::string_view lineAt(std::string_view text, std::size_t pos)
+{
+    std::size_t end = text.find('\n', pos);
+    return text.substr(pos, (end == std::string_view::npos ? text.size() : end) - pos);
+}
+
+static bool isBlank(std::string_view line)
+{
+    for (char c : line)
+    {
+        if (!isSpace(c))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool nextPgnGame(std::string_view text, std::size_t& pos, std::string_view& game)
+{
+    while (pos < text.size() && isSpace(text[pos]))
+    {
+        ++pos;
+    }
+
+    if (pos >= text.size())
+    {
+        return false;
+    }
+
+    std::size_t start = pos;
+    bool in_movetext = false;
+
+    while (pos < text.size())
+    {
+        std::string_view line = lineAt(text, pos);
+
+        if (!line.empty() && line[0] == '[')
+        {
+            if (in_movetext)
+            {
+                break;
+            }
+        }
+        else if (!isBlank(line))
+        {
+            in_movetext = true;
+        }
+
+        pos += line.size() + 1;
+    }
+
+    pos = std::min(pos, text.size());
+    game = text.substr(start, pos - start);
+
+    return true;
+}
+
+// [Name "Value"], the value without its quotes
+static bool parseTag(std::string_view line, std::string_view& name, std::string_view& value)
+{
+    std::size_t space = line.find(' ');
+    std::size_t open = line.find('"');
+    std::size_t close = line.rfind('"');
+
+    if (space == std::string_view::npos || open == std::string_view::npos || close <= open)
+    {
+        return false;
+    }
+
+    name = line.substr(1, space - 1);
+    value = line.substr(open + 1, close - open - 1);
+
+    return true;
+}
+
+static bool isResult(std::string_view token)
+{
+    return token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*";
+}
+
+PgnCheck checkPgnGame(std::string_view game, Chess& position, std::vector<Move>* moves)
+{
+    PgnCheck check;
+    std::string_view fen = START_FEN;
+    std::size_t pos = 0;
+
+    // tag section
+    while (pos < game.size())
+    {
+        std::string_view line = lineAt(game, pos);
+
+        if (!line.empty() && line[0] == '[')
+        {
+            std::string_view name;
+            std::string_view value;
+
+            if (parseTag(line, name, value))
+            {
+                if (name == "FEN")
+                {
+                    fen = value;
+                    check.setup = value;
+                }
+                else if (name == "Result")
+                {
+                    check.result = value;
+                }
+            }
+        }
+        else if (!isBlank(line))
+        {
+            break;
+        }
+
+        pos += line.size() + 1;
+    }
+
+    if (!position.fromFEN(std::string(fen)))
+    {
+        check.legal = false;
+        check.bad_move = "FEN";
+        return check;
+    }
+
+    // movetext: move numbers, comments, variations and NAGs are skipped, everything else is SAN
+    int variation_depth = 0;
+
+    while (pos < game.size())
+    {
+        char c = game[pos];
+
+        if (isSpace(c))
+        {
+            ++pos;
+        }
+        else if (c == '{')
+        {
+            std::size_t end = game.find('}', pos);
+            pos = end == std::string_view::npos ? game.size() : end + 1;
+        }
+        else if (c == ';' || (c == '%' && (pos == 0 || game[pos - 1] == '\n')))
+        {
+            pos += lineAt(game, pos).size();
+        }
+        else if (c == '(')
+        {
+            ++variation_depth;
+            ++pos;
+        }
+        else if (c == ')')
+        {
+            variation_depth = std::max(0, variation_depth - 1);
+            ++pos;
+        }
+        else
+        {
+            std::size_t start = pos;
+            while (pos < game.size() && !isSpace(game[pos]) && game[pos] != '{' && game[pos] != '(' &&
+                    game[pos] != ')' && game[pos] != ';')
+            {
+                ++pos;
+            }
+
+            std::string_view token = game.substr(start, pos - start);
+
+            if (variation_depth > 0 || token[0] == '$')
+            {
+                continue;
+            }
+
+            if (isResult(token))
+            {
+                break;
+            }
+
+            // "12." and "12..." alone, or glued to the move as in "12.e4"
+            std::size_t digits = 0;
+            while (digits < token.size() && '0' <= token[digits] && token[digits] <= '9')
+            {
+                ++digits;
+            }
+
+            if (digits < token.size() && token[digits] == '.')
+            {
+                token.remove_prefix(digits);
+                while (!token.empty() && token[0] == '.')
+                {
+                    token.remove_prefix(1);
+                }
+            }
+
+            if (token.empty())
+            {
+                continue;
+            }
+
+            Move move = position.parseSAN(token);
+            if (move == NO_MOVE)
+            {
+                check.legal = false;
+                check.bad_move = token;
+                break;
+            }
+
+            position.doMove(move);
+            ++check.plies;
+
+            if (moves)
+            {
+                moves->push_back(move);
+            }
+        }
+    }
+
+    check.fen = position.toFEN();
+
+    return check;
+}
+
+// games a worker takes from a batch at a time
+constexpr std::size_t CLAIM_GAMES = 64;
+
+PgnReplayPool::PgnReplayPool(int threads, bool keep_moves) : m_keep_moves(keep_moves), m_stop(false)
+{
+    for (int i = 0; i < std::max(1, threads); ++i)
+    {
+        m_workers.emplace_back(&PgnReplayPool::work, this);
+    }
+}
+
+PgnReplayPool::~PgnReplayPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+
+    m_work.notify_all();
+
+    for (std::thread& worker : m_workers)
+    {
+        worker.join();
+    }
+}
+
+void PgnReplayPool::work()
+{
+    Chess position;
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (true)
+    {
+        Batch* batch = nullptr;
+        for (const std::unique_ptr<Batch>& queued : m_batches)
+        {
+            if (queued->next < queued->games.size())
+            {
+                batch = queued.get();
+                break;
+            }
+        }
+
+        if (!batch)
+        {
+            if (m_stop)
+            {
+                return;
+            }
+
+            m_work.wait(lock);
+            continue;
+        }
+
+        std::size_t first = batch->next;
+        std::size_t last = std::min(first + CLAIM_GAMES, batch->games.size());
+        batch->next = last;
+
+        lock.unlock();
+
+        for (std::size_t i = first; i < last; ++i)
+        {
+            PgnGame& result = batch->results[i];
+            result.moves.clear();
+            result.check = checkPgnGame(batch->games[i], position, m_keep_moves ? &result.moves : nullptr);
+        }
+
+        lock.lock();
+
+        // the batch stays queued until every game has finished
+        batch->finished += last - first;
+        if (batch->finished == batch->games.size())
+        {
+            m_finished.notify_all();
+        }
+    }
+}
+
+// waits for the oldest batch and passes its results to done
+void PgnReplayPool::handBack(const std::function<void(const std::vector<PgnGame>&)>& done)
+{
+    std::unique_ptr<Batch> batch;
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_finished.wait(lock, [this]()
+        {
+            return m_batches.front()->finished == m_batches.front()->games.size();
+        });
+
+        batch = std::move(m_batches.front());
+        m_batches.pop_front();
+    }
+
+    done(batch->results);
+
+    batch->games.clear();
+    batch->next = 0;
+    batch->finished = 0;
+    m_spare.push_back(std::move(batch));
+}
+
+void PgnReplayPool::replay(std::string_view text, const std::function<void(const std::vector<PgnGame>&)>& done)
+{
+    std::size_t pos = 0;
+    std::string_view game;
+
+    while (true)
+    {
+        std::unique_ptr<Batch> batch;
+        if (m_spare.empty())
+        {
+            batch.reset(new Batch());
+        }
+
+        else
+        {
+            batch = std::move(m_spare.back());
+            m_spare.pop_back();
+        }
+
+        while (batch->games.size() < BATCH_GAMES && nextPgnGame(text, pos, game))
+        {
+            batch->games.push_back(game);
+        }
+
+        if (batch->games.empty())
+        {
+            m_spare.push_back(std::move(batch));
+            break;
+        }
+
+        batch->results.resize(batch->games.size());
+
+        // only the reading thread adds or removes batches, so the count is safe to read here
+        if (m_batches.size() >= QUEUED_BATCHES)
+        {
+            handBack(done);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_batches.push_back(std::move(batch));
+        }
+
+        m_work.notify_all();
+    }
+
+    while (!m_batches.empty())
+    {
+        handBack(done);
+    }
+}
@@ -0,0 +1,96 @@
+#include "chess.h"
+#include "mappedfile.h"
+#include "pgn.h"
+#include "timer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+static void usage()
+{
+    std::cout << "usage: pgn-check [-j threads] file.pgn...    replay every game, one line per game in input order:" << std::endl;
+    std::cout << "                                             number, ok or illegal, plies, bad move, result tag, final FEN" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+        {
+            threads = std::max(1, std::atoi(argv[++i]));
+        }
+
+        else
+        {
+            files.push_back(argv[i]);
+        }
+    }
+
+    if (files.empty())
+    {
+        usage();
+        return EXIT_FAILURE;
+    }
+
+    std::uint64_t total = 0;
+    std::uint64_t illegal = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    PgnReplayPool pool(threads, false);
+    std::string output;
+
+    // one line per game, written in input order as the batches come back
+    auto report = [&total, &illegal, &output](const std::vector<PgnGame>& results)
+    {
+        output.clear();
+        for (const PgnGame& game : results)
+        {
+            const PgnCheck& check = game.check;
+            ++total;
+            illegal += !check.legal;
+
+            output += std::to_string(total);
+            output += check.legal ? "\tok\t" : "\tillegal\t";
+            output += std::to_string(check.plies);
+            output += '\t';
+            output += check.legal ? "-" : check.bad_move;
+            output += '\t';
+            output += check.result;
+            output += '\t';
+            output += check.fen;
+            output += '\n';
+        }
+
+        std::cout.write(output.data(), output.size());
+    };
+
+    for (const std::string& path : files)
+    {
+        MappedFile file;
+        if (!file.open(path, true))
+        {
+            std::cerr << "cannot open " << path << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        pool.replay(file.view(), report);
+    }
+
+    std::cout.flush();
+
+    double time = seconds(start);
+    std::cerr << total << " games, " << illegal << " illegal, " << time << "s, "
+        << static_cast<std::uint64_t>(total / (time > 0 ? time : 1e-9)) << " games/s with " << threads << " threads"
+        << std::endl;
+
+    return illegal ? EXIT_FAILURE : EXIT_SUCCESS;
+}
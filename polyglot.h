@@ -0,0 +1,61 @@
+#ifndef POLYGLOT_H
+#define POLYGLOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+#include "chess.h"
+#include "gamedb.h"
+#include "mappedfile.h"
+
+// Polyglot opening books: 16-byte big-endian entries (uint64 key, uint16 move,
+// uint16 weight, uint32 learn) sorted by key. The key is a Zobrist hash over
+// Polyglot's 781 Random64 numbers (Chess::polyglotKey), not the engine's own.
+constexpr int POLYGLOT_RANDOMS = 781;
+constexpr std::size_t POLYGLOT_ENTRY_SIZE = 16;
+
+// book moves: to file/rank in bits 0-5, from in 6-11, promotion piece 1-4 (N-Q) in
+// 12-14, castling written as the king taking its own rook
+std::uint16_t toPolyglotMove(const Move& move);
+
+struct BookMove {
+    Move move;
+    int weight;
+};
+
+class PolyglotBook {
+    private:
+        MappedFile m_file;
+        const unsigned char* m_entries;
+        std::size_t m_size;
+        std::mt19937 m_random;
+
+    public:
+        PolyglotBook();
+        ~PolyglotBook() = default;
+
+        bool open(const std::string& path); // false when missing or not a whole number of entries
+        void close();
+        bool isOpen() const;
+        std::size_t size() const;
+
+        std::vector<BookMove> probe(const Chess& position) const; // legal book moves, heaviest first
+        Move pick(const Chess& position, bool best = false); // random by weight unless best, NO_MOVE out of book
+};
+
+struct BookBuildOptions {
+    int threads = 1;
+    int max_ply = 40; // positions deeper into a game are left out
+    std::size_t memory_mb = 256; // for the sort, beyond that sorted runs go to temporary files
+    int min_games = 1; // moves played in fewer games are left out
+};
+
+// Counts every move of the games that have a result up to max_ply: 2 points
+// for a win of the side that played it, 1 for a draw, scaled per position so
+// the weights fit 16 bits. Moves that never scored are dropped. False when
+// writing fails or a game record of db is damaged.
+bool buildPolyglotBook(const GameDb& db, const std::string& path, const BookBuildOptions& options);
+
+#endif
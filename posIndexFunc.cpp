@@ -0,0 +1,288 @@
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <thread>
+#include <vector>
+#include "posindex.h"
+#include "sortedruns.h"
+
+// games a worker takes from the queue at a time
+constexpr std::size_t INDEX_CHUNK = 256;
+
+static bool entryLess(const PositionEntry& a, const PositionEntry& b)
+{
+    if (a.hash != b.hash)
+    {
+        return a.hash < b.hash;
+    }
+
+    return a.game != b.game ? a.game < b.game : a.ply < b.ply;
+}
+
+static std::size_t bucketOf(std::uint64_t hash)
+{
+    return static_cast<std::size_t>(hash >> 48);
+}
+
+// repetitions: keep the first time a game reached the position
+static bool sameGame(const PositionEntry& a, const PositionEntry& b)
+{
+    return a.hash == b.hash && a.game == b.game;
+}
+
+bool buildPositionIndex(const GameDb& db, const std::string& path, int threads, std::size_t memory_mb)
+{
+    threads = std::max(1, threads);
+    std::size_t capacity = std::max<std::size_t>(memory_mb * 1024 * 1024 / sizeof(PositionEntry) / threads, 1024);
+
+    SortedRuns<PositionEntry> runs(path);
+    std::atomic<std::size_t> next(0);
+    std::atomic<bool> damaged(false);
+
+    // each worker replays whole games, a sorted run whenever its buffer is full
+    auto worker = [&db, &runs, &next, &damaged, capacity]()
+    {
+        std::vector<PositionEntry> entries;
+        entries.reserve(capacity);
+        Chess position;
+        std::size_t first;
+
+        auto flush = [&runs, &entries]()
+        {
+            std::sort(entries.begin(), entries.end(), entryLess);
+            entries.erase(std::unique(entries.begin(), entries.end(), sameGame), entries.end());
+            runs.add(entries);
+            entries.clear();
+        };
+
+        while ((first = next.fetch_add(INDEX_CHUNK, std::memory_order_relaxed)) < db.size())
+        {
+            std::size_t last = std::min(first + INDEX_CHUNK, db.size());
+
+            for (std::size_t i = first; i < last; ++i)
+            {
+                GameRecord game;
+                if (!db.game(i, game))
+                {
+                    damaged = true;
+                    continue;
+                }
+
+                GameReplay replay(game, position);
+                PositionEntry entry = {0, static_cast<std::uint32_t>(i), 0, game.outcome, 0};
+
+                do
+                {
+                    if (entries.size() == capacity)
+                    {
+                        flush();
+                    }
+
+                    entry.hash = position.getHash();
+                    entry.ply = static_cast<std::uint16_t>(replay.ply());
+                    entries.push_back(entry);
+                }
+                while (replay.next());
+
+                if (replay.damaged())
+                {
+                    damaged = true;
+                }
+            }
+        }
+
+        if (!entries.empty())
+        {
+            flush();
+        }
+    };
+
+    std::vector<std::thread> helpers;
+    for (int i = 1; i < threads; ++i)
+    {
+        helpers.emplace_back(worker);
+    }
+
+    worker();
+
+    for (std::thread& helper : helpers)
+    {
+        helper.join();
+    }
+
+    if (damaged)
+    {
+        return false;
+    }
+
+    // the counts and buckets are only known once every entry went by, so they
+    // are written as placeholders first and filled in at the end
+    std::vector<std::uint64_t> buckets(POSINDEX_BUCKETS + 1, 0);
+    std::uint64_t counts[2] = {0, db.size()};
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write("CPIX", 4);
+    file.write(reinterpret_cast<const char*>(&POSINDEX_VERSION), sizeof(POSINDEX_VERSION));
+    file.write(reinterpret_cast<const char*>(counts), sizeof(counts));
+    file.write(reinterpret_cast<const char*>(buckets.data()), buckets.size() * sizeof(std::uint64_t));
+
+    std::vector<PositionEntry> buffer;
+    buffer.reserve(1 << 16);
+    PositionEntry previous = {0, 0, 0, GameOutcome::Unknown, 0};
+
+    // runs are each free of repetitions, but one game may be split over two
+    bool merged = runs.merge(entryLess, [&](const PositionEntry& entry)
+    {
+        if (counts[0] > 0 && sameGame(previous, entry))
+        {
+            return;
+        }
+
+        previous = entry;
+        ++counts[0];
+        ++buckets[bucketOf(entry.hash) + 1];
+        buffer.push_back(entry);
+
+        if (buffer.size() == buffer.capacity())
+        {
+            file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size() * sizeof(PositionEntry));
+            buffer.clear();
+        }
+    });
+
+    file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size() * sizeof(PositionEntry));
+
+    for (std::size_t i = 1; i <= POSINDEX_BUCKETS; ++i)
+    {
+        buckets[i] += buckets[i - 1];
+    }
+
+    file.seekp(8);
+    file.write(reinterpret_cast<const char*>(counts), sizeof(counts));
+    file.write(reinterpret_cast<const char*>(buckets.data()), buckets.size() * sizeof(std::uint64_t));
+
+    return merged && static_cast<bool>(file);
+}
+
+PositionIndex::PositionIndex() : m_buckets(nullptr), m_entries(nullptr), m_size(0), m_games(0) {}
+
+bool PositionIndex::open(const std::string& path)
+{
+    m_buckets = nullptr;
+    m_entries = nullptr;
+    m_size = 0;
+    m_games = 0;
+
+    if (!m_file.open(path))
+    {
+        return false;
+    }
+
+    const char* data = m_file.data();
+    std::size_t tables = POSINDEX_HEADER_SIZE + (POSINDEX_BUCKETS + 1) * sizeof(std::uint64_t);
+
+    std::uint32_t version = 0;
+    std::uint64_t counts[2] = {0, 0};
+
+    if (m_file.size() >= tables)
+    {
+        std::memcpy(&version, data + 4, sizeof(version));
+        std::memcpy(counts, data + 8, sizeof(counts));
+    }
+
+    if (m_file.size() < tables || std::memcmp(data, "CPIX", 4) != 0 || version != POSINDEX_VERSION ||
+            (m_file.size() - tables) / sizeof(PositionEntry) != counts[0])
+    {
+        m_file.close();
+        return false;
+    }
+
+    // lookups read entries between neighbouring buckets, so the table has to start
+    // at 0, never decrease and end at the entry count
+    const std::uint64_t* buckets = reinterpret_cast<const std::uint64_t*>(data + POSINDEX_HEADER_SIZE);
+    bool sorted = buckets[0] == 0 && buckets[POSINDEX_BUCKETS] == counts[0];
+
+    for (std::size_t i = 0; sorted && i < POSINDEX_BUCKETS; ++i)
+    {
+        sorted = buckets[i] <= buckets[i + 1];
+    }
+
+    if (!sorted)
+    {
+        m_file.close();
+        return false;
+    }
+
+    m_buckets = buckets;
+    m_entries = reinterpret_cast<const PositionEntry*>(data + tables);
+    m_size = counts[0];
+    m_games = counts[1];
+
+    return true;
+}
+
+std::size_t PositionIndex::size() const
+{
+    return m_size;
+}
+
+std::size_t PositionIndex::games() const
+{
+    return m_games;
+}
+
+std::pair<const PositionEntry*, const PositionEntry*> PositionIndex::find(std::uint64_t hash) const
+{
+    if (!m_entries)
+    {
+        return {nullptr, nullptr};
+    }
+
+    std::size_t bucket = bucketOf(hash);
+    const PositionEntry* first = m_entries + m_buckets[bucket];
+    const PositionEntry* last = m_entries + m_buckets[bucket + 1];
+
+    first = std::lower_bound(first, last, hash, [](const PositionEntry& entry, std::uint64_t key)
+    {
+        return entry.hash < key;
+    });
+
+    last = std::upper_bound(first, last, hash, [](std::uint64_t key, const PositionEntry& entry)
+    {
+        return key < entry.hash;
+    });
+
+    return {first, last};
+}
+
+PositionStats PositionIndex::stats(std::uint64_t hash) const
+{
+    PositionStats stats;
+    auto range = find(hash);
+
+    for (const PositionEntry* entry = range.first; entry != range.second; ++entry)
+    {
+        ++stats.games;
+
+        switch (entry->outcome)
+        {
+            case GameOutcome::WhiteWins:
+                ++stats.white_wins;
+                break;
+
+            case GameOutcome::BlackWins:
+                ++stats.black_wins;
+                break;
+
+            case GameOutcome::Draw:
+                ++stats.draws;
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    return stats;
+}
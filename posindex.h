@@ -0,0 +1,71 @@
+#ifndef POSINDEX_H
+#define POSINDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include "gamedb.h"
+#include "mappedfile.h"
+
+// one position of one game: where it was reached and how that game ended
+struct PositionEntry {
+    std::uint64_t hash;
+    std::uint32_t game; // index in the game file
+    std::uint16_t ply;
+    GameOutcome outcome;
+    std::uint8_t unused;
+};
+
+static_assert(sizeof(PositionEntry) == 16, "index entries are written as they are in memory");
+
+// Index file, next to a game file:
+//   header   "CPIX", uint32 version, uint64 entry count, uint64 game count
+//   buckets  POSINDEX_BUCKETS + 1 uint64, the first entry whose hash starts
+//            with each value of its top 16 bits
+//   entries  PositionEntry sorted by hash, game, ply; a position met again
+//            later in the same game is only listed at its first ply
+// Entries are stored as in memory, little-endian on every target we build for.
+constexpr std::uint32_t POSINDEX_VERSION = 1;
+constexpr std::size_t POSINDEX_HEADER_SIZE = 24;
+constexpr std::size_t POSINDEX_BUCKETS = 1 << 16;
+
+// games through a position, counted once per game
+struct PositionStats {
+    std::uint64_t games = 0;
+    std::uint64_t white_wins = 0;
+    std::uint64_t draws = 0;
+    std::uint64_t black_wins = 0; // games minus the three is the unfinished ones
+};
+
+// Replays every game of db on threads workers and writes the sorted index.
+// Positions are sorted in memory_mb megabytes at most, 16 bytes each; beyond
+// that sorted runs go to temporary files next to path and are merged. False
+// when writing fails or a game record of db is damaged.
+bool buildPositionIndex(const GameDb& db, const std::string& path, int threads, std::size_t memory_mb = 256);
+
+// Read side: the file stays mapped, a lookup jumps to the hash's bucket and
+// binary searches inside it.
+class PositionIndex {
+    private:
+        MappedFile m_file;
+        const std::uint64_t* m_buckets;
+        const PositionEntry* m_entries;
+        std::size_t m_size;
+        std::size_t m_games;
+
+    public:
+        PositionIndex();
+        ~PositionIndex() = default;
+
+        bool open(const std::string& path); // false when missing or not a valid index
+
+        std::size_t size() const;
+        std::size_t games() const; // in the game file it was built from
+
+        // every game that reached the position, as [first, last)
+        std::pair<const PositionEntry*, const PositionEntry*> find(std::uint64_t hash) const;
+        PositionStats stats(std::uint64_t hash) const;
+};
+
+#endif
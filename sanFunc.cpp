@@ -0,0 +1,209 @@
+#include "chess.h"
+
+// Standard algebraic notation as found in PGN files: Nf3, exd5, Rae1, e8=Q,
+// O-O-O, with check marks and !? annotations ignored. The candidate pieces are
+// found backwards from the target square with the attack tables. Out of check,
+// an unpinned piece that is not the king is legal as soon as it may land there;
+// anything else goes through isLegalMove. NO_MOVE when none or more than one is legal.
+Move Chess::parseSAN(std::string_view san) const
+{
+    while (!san.empty() && (san.back() == '+' || san.back() == '#' || san.back() == '!' || san.back() == '?'))
+    {
+        san.remove_suffix(1);
+    }
+
+    int us = static_cast<int>(m_player_turn);
+    int king = kingSquare(us);
+
+    if (san == "O-O" || san == "0-0" || san == "O-O-O" || san == "0-0-0")
+    {
+        bool king_side = san.size() == 3;
+        Move castle = {static_cast<std::uint8_t>(king), static_cast<std::uint8_t>(king_side ? king + 2 : king - 2),
+            king_side ? MoveType::CastleRight : MoveType::CastleLeft, FigureType::Queen};
+
+        return isLegalMove(castle) ? castle : NO_MOVE;
+    }
+
+    int type = static_cast<int>(FigureType::Pawn);
+    int promote = NO_PIECE;
+
+    static const std::string_view pieces = "PNBRQK";
+
+    if (san.size() >= 3 && pieces.find(san.back()) != std::string_view::npos)
+    {
+        promote = static_cast<int>(pieces.find(san.back()));
+        san.remove_suffix(1);
+
+        if (promote == static_cast<int>(FigureType::Pawn) || promote == static_cast<int>(FigureType::King))
+        {
+            return NO_MOVE;
+        }
+
+        if (san.back() == '=')
+        {
+            san.remove_suffix(1);
+        }
+    }
+
+    if (!san.empty() && pieces.find(san.front()) != std::string_view::npos)
+    {
+        type = static_cast<int>(pieces.find(san.front()));
+        san.remove_prefix(1);
+    }
+
+    if (san.size() < 2 || !borderCheck(san[san.size() - 2] - 'a') || !borderCheck(san.back() - '1'))
+    {
+        return NO_MOVE;
+    }
+
+    int to = makeSquare(san[san.size() - 2] - 'a', san.back() - '1');
+    san.remove_suffix(2);
+
+    // what is left: disambiguating file and/or rank, and the capture mark
+    int from_file = -1;
+    int from_rank = -1;
+    bool capture = false;
+
+    for (char c : san)
+    {
+        if (c == 'x')
+        {
+            capture = true;
+        }
+        else if ('a' <= c && c <= 'h')
+        {
+            from_file = c - 'a';
+        }
+        else if ('1' <= c && c <= '8')
+        {
+            from_rank = c - '1';
+        }
+        else
+        {
+            return NO_MOVE;
+        }
+    }
+
+    Bitboard own = m_board.pieces[us][type];
+    Bitboard sources = 0;
+
+    switch (static_cast<FigureType>(type))
+    {
+        case FigureType::Pawn:
+        {
+            int push = us == 0 ? 8 : -8;
+            int relative_rank = us == 0 ? rankOf(to) : 7 - rankOf(to);
+
+            // a pawn capture always names its file, a push never does
+            if (capture || from_file >= 0)
+            {
+                sources = pawnAttacks(1 - us, to) & own;
+            }
+            else if (relative_rank >= 2)
+            {
+                sources = own & squareBit(to - push);
+
+                if (!sources && relative_rank == 3 && !(m_board.all & squareBit(to - push)))
+                {
+                    sources = own & squareBit(to - 2 * push);
+                }
+            }
+
+            break;
+        }
+
+        case FigureType::Knight:
+            sources = knightAttacks(to) & own;
+            break;
+
+        case FigureType::Bishop:
+            sources = bishopAttacks(to, m_board.all) & own;
+            break;
+
+        case FigureType::Rook:
+            sources = rookAttacks(to, m_board.all) & own;
+            break;
+
+        case FigureType::Queen:
+            sources = queenAttacks(to, m_board.all) & own;
+            break;
+
+        case FigureType::King:
+            sources = kingAttacks(to) & own;
+            break;
+    }
+
+    if (m_board.occupancy[us] & squareBit(to))
+    {
+        return NO_MOVE;
+    }
+
+    // pushes need an empty square, captures other than en passant an enemy piece
+    if (type == static_cast<int>(FigureType::Pawn) && to != m_en_passant &&
+            !(m_board.all & squareBit(to)) != !(capture || from_file >= 0))
+    {
+        return NO_MOVE;
+    }
+
+    // a piece move is marked as a capture exactly when it takes something
+    if (type != static_cast<int>(FigureType::Pawn) && capture != static_cast<bool>(m_board.all & squareBit(to)))
+    {
+        return NO_MOVE;
+    }
+
+    bool simple = type != static_cast<int>(FigureType::King) && !checkers();
+    Bitboard pinned = simple ? pinnedPieces(us) : 0;
+
+    Move found = NO_MOVE;
+
+    while (sources)
+    {
+        int from = popLsb(sources);
+
+        if ((from_file >= 0 && fileOf(from) != from_file) || (from_rank >= 0 && rankOf(from) != from_rank))
+        {
+            continue;
+        }
+
+        Move move = {static_cast<std::uint8_t>(from), static_cast<std::uint8_t>(to), MoveType::None, FigureType::Queen};
+
+        if (type == static_cast<int>(FigureType::Pawn))
+        {
+            int last_rank = us == 0 ? 7 : 0;
+
+            if (rankOf(to) == last_rank)
+            {
+                if (promote == NO_PIECE)
+                {
+                    return NO_MOVE;
+                }
+
+                move.type = MoveType::Promote;
+                move.promote = static_cast<FigureType>(promote);
+            }
+            else if (to == m_en_passant)
+            {
+                move.type = MoveType::Passant;
+            }
+        }
+
+        if (promote != NO_PIECE && move.type != MoveType::Promote)
+        {
+            return NO_MOVE;
+        }
+
+        bool quick = simple && move.type != MoveType::Passant && !(pinned & squareBit(from));
+
+        if (quick || isLegalMove(move))
+        {
+            if (found != NO_MOVE)
+            {
+                return NO_MOVE;
+            }
+
+            found = move;
+        }
+    }
+
+    return found;
+}
@@ -0,0 +1,102 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "chess.h"
+#include "movepick.h"
+#include "tt.h"
+
+constexpr int MAX_PLY = 128;
+
+constexpr int SCORE_INFINITE = 32001;
+constexpr int SCORE_MATE = 32000;
+constexpr int SCORE_MATE_IN_MAX_PLY = SCORE_MATE - MAX_PLY;
+
+struct SearchLimits {
+    int depth = MAX_PLY - 1;
+    std::uint64_t nodes = 0; // 0 for no limit
+    int movetime = 0; // milliseconds, 0 for no limit
+    int threads = 1;
+    bool quiet_ordering = true; // killers, counter moves and history; off gives the MVV-LVA-only baseline
+};
+
+struct SearchResult {
+    Move best_move = NO_MOVE;
+    int score = 0;
+    int depth = 0;
+    std::uint64_t nodes = 0; // all threads
+    std::int64_t time = 0; // milliseconds since the search started
+    std::vector<Move> pv;
+};
+
+// called by the main thread after every completed iteration
+using SearchInfoCallback = std::function<void(const SearchResult&)>;
+
+// Iterative deepening negamax with PVS, aspiration windows, null-move pruning,
+// late move reductions and a quiescence search, on its own copy of the position.
+// With more than one thread, helpers search the same root on their own copies
+// and meet through the shared hash table (lazy SMP).
+class Search {
+    private:
+        Chess m_position;
+        TranspositionTable& m_tt;
+
+        int m_thread_id; // 0 is the main thread, the only one watching the limits
+        std::atomic<bool> m_stop_flag;
+        std::atomic<bool>* m_stop_signal; // our own flag, or the main thread's for helpers
+
+        SearchLimits m_limits;
+        std::chrono::steady_clock::time_point m_start;
+        std::uint64_t m_nodes;
+        std::atomic<std::uint64_t> m_shared_nodes; // m_nodes as other threads may read it, every 1024 nodes
+        bool m_stopped;
+
+        std::vector<std::unique_ptr<Search>> m_helpers;
+        SearchInfoCallback m_info;
+
+        int m_ply;
+        Move m_pv[MAX_PLY][MAX_PLY];
+        int m_pv_length[MAX_PLY];
+
+        // quiet move ordering, learned from the cutoffs of this search
+        Move m_killers[MAX_PLY][2];
+        Move m_counter_moves[SQUARE_NB][SQUARE_NB]; // reply to the opponent's last [from][to]
+        HistoryTable m_history;
+
+        PawnTable m_pawn_table; // per thread, so helpers never share entries
+
+        Search(const Chess& position, TranspositionTable& tt, int thread_id, std::atomic<bool>* stop_signal);
+
+        void checkLimits();
+        std::uint64_t totalNodes() const;
+        std::int64_t elapsed() const;
+        bool skipDepth(int depth) const;
+
+        SearchResult iterate();
+
+        void updateQuietStats(const Move& move, int depth, const Move* tried, int tried_count);
+
+        int negamax(int alpha, int beta, int depth, bool null_allowed);
+        int quiescence(int alpha, int beta);
+
+        void updatePv(const Move& move);
+
+        static int scoreToTT(int score, int ply);
+        static int scoreFromTT(int score, int ply);
+
+    public:
+        Search(const Chess& position, TranspositionTable& tt);
+        ~Search() = default;
+
+        SearchResult run(const SearchLimits& limits);
+        void stop(); // safe to call from another thread
+
+        void setInfoCallback(SearchInfoCallback info);
+};
+
+#endif
@@ -0,0 +1,621 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <thread>
+#include <utility>
+#include "search.h"
+
+// late move reduction by remaining depth and move number
+static int reductions[MAX_PLY][MAX_MOVES];
+
+static bool initReductions()
+{
+    for (int depth = 1; depth < MAX_PLY; ++depth)
+    {
+        for (int count = 1; count < MAX_MOVES; ++count)
+        {
+            reductions[depth][count] = static_cast<int>(0.75 + std::log(depth) * std::log(count) / 2.25);
+        }
+    }
+
+    return true;
+}
+
+Search::Search(const Chess& position, TranspositionTable& tt) : Search(position, tt, 0, nullptr) {}
+
+Search::Search(const Chess& position, TranspositionTable& tt, int thread_id, std::atomic<bool>* stop_signal) :
+    m_position(position), m_tt(tt), m_thread_id(thread_id), m_stop_flag(false),
+    m_stop_signal(stop_signal ? stop_signal : &m_stop_flag), m_nodes(0), m_shared_nodes(0), m_stopped(false), m_ply(0), m_pv_length(),
+    m_killers(), m_counter_moves(), m_history()
+{
+    static const bool initialized = initReductions();
+    (void)initialized;
+}
+
+void Search::stop()
+{
+    m_stop_signal->store(true, std::memory_order_relaxed);
+}
+
+void Search::setInfoCallback(SearchInfoCallback info)
+{
+    m_info = std::move(info);
+}
+
+// the main thread's own count plus what the helpers last published
+std::uint64_t Search::totalNodes() const
+{
+    std::uint64_t nodes = m_nodes;
+
+    for (const std::unique_ptr<Search>& helper : m_helpers)
+    {
+        nodes += helper->m_shared_nodes.load(std::memory_order_relaxed);
+    }
+
+    return nodes;
+}
+
+std::int64_t Search::elapsed() const
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_start).count();
+}
+
+// mate scores are stored relative to the node so they stay right when reached by another path
+int Search::scoreToTT(int score, int ply)
+{
+    if (score >= SCORE_MATE_IN_MAX_PLY)
+    {
+        return score + ply;
+    }
+
+    if (score <= -SCORE_MATE_IN_MAX_PLY)
+    {
+        return score - ply;
+    }
+
+    return score;
+}
+
+int Search::scoreFromTT(int score, int ply)
+{
+    if (score >= SCORE_MATE_IN_MAX_PLY)
+    {
+        return score - ply;
+    }
+
+    if (score <= -SCORE_MATE_IN_MAX_PLY)
+    {
+        return score + ply;
+    }
+
+    return score;
+}
+
+void Search::checkLimits()
+{
+    if ((m_nodes & 1023) == 0)
+    {
+        m_shared_nodes.store(m_nodes, std::memory_order_relaxed);
+
+        if (m_stop_signal->load(std::memory_order_relaxed))
+        {
+            m_stopped = true;
+        }
+    }
+
+    if (m_thread_id != 0)
+    {
+        return;
+    }
+
+    // helpers publish their counts every 1024 nodes, so with several threads the
+    // limit is checked as often and the search may overrun it by that much per thread
+    if (m_limits.nodes && (m_helpers.empty() || (m_nodes & 1023) == 0) && totalNodes() >= m_limits.nodes)
+    {
+        m_stopped = true;
+    }
+
+    if (m_limits.movetime && (m_nodes & 1023) == 0 && elapsed() >= m_limits.movetime)
+    {
+        m_stopped = true;
+    }
+
+    if (m_stopped)
+    {
+        stop();
+    }
+}
+
+// helpers skip some iterations so the threads spread over neighbouring depths
+bool Search::skipDepth(int depth) const
+{
+    static const int skip_size[] = {1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4};
+    static const int skip_phase[] = {0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7};
+
+    if (m_thread_id == 0)
+    {
+        return false;
+    }
+
+    int i = (m_thread_id - 1) % 20;
+    return ((depth + skip_phase[i]) / skip_size[i]) % 2;
+}
+
+// the history of a move moves towards +-HISTORY_MAX, by less the closer it already is
+static void updateHistory(int& entry, int bonus)
+{
+    entry += bonus - entry * std::abs(bonus) / HISTORY_MAX;
+}
+
+// a quiet move caused a cutoff: remember it as a killer and a counter move, and
+// reward it in the history while the quiet moves tried before it are penalized
+void Search::updateQuietStats(const Move& move, int depth, const Move* tried, int tried_count)
+{
+    if (m_killers[m_ply][0] != move)
+    {
+        m_killers[m_ply][1] = m_killers[m_ply][0];
+        m_killers[m_ply][0] = move;
+    }
+
+    Move previous = m_position.lastMove();
+    if (previous != NO_MOVE)
+    {
+        m_counter_moves[previous.from][previous.to] = move;
+    }
+
+    int us = static_cast<int>(m_position.getPlayerType());
+    int bonus = std::min(depth * depth, 400);
+
+    updateHistory(m_history[us][move.from][move.to], bonus);
+
+    for (int i = 0; i < tried_count; ++i)
+    {
+        updateHistory(m_history[us][tried[i].from][tried[i].to], -bonus);
+    }
+}
+
+void Search::updatePv(const Move& move)
+{
+    m_pv[m_ply][m_ply] = move;
+
+    for (int i = m_ply + 1; i < m_pv_length[m_ply + 1]; ++i)
+    {
+        m_pv[m_ply][i] = m_pv[m_ply + 1][i];
+    }
+
+    m_pv_length[m_ply] = std::max(m_pv_length[m_ply + 1], m_ply + 1);
+}
+
+int Search::quiescence(int alpha, int beta)
+{
+    m_pv_length[m_ply] = m_ply;
+
+    checkLimits();
+    if (m_stopped)
+    {
+        return 0;
+    }
+
+    ++m_nodes;
+
+    if (m_ply >= MAX_PLY - 1)
+    {
+        return m_position.evaluate(&m_pawn_table);
+    }
+
+    bool in_check = m_position.inCheck();
+    int best_score = -SCORE_INFINITE;
+
+    if (!in_check)
+    {
+        best_score = m_position.evaluate(&m_pawn_table);
+
+        if (best_score >= beta)
+        {
+            return best_score;
+        }
+
+        alpha = std::max(alpha, best_score);
+    }
+
+    MovePicker picker(m_position, !in_check);
+    int move_count = 0;
+    Move move;
+
+    while ((move = picker.next()) != NO_MOVE)
+    {
+        ++move_count;
+
+        m_position.doMove(move);
+        ++m_ply;
+
+        int score = -quiescence(-beta, -alpha);
+
+        --m_ply;
+        m_position.undoMove();
+
+        if (m_stopped)
+        {
+            return 0;
+        }
+
+        if (score > best_score)
+        {
+            best_score = score;
+
+            if (score > alpha)
+            {
+                if (score >= beta)
+                {
+                    break;
+                }
+
+                alpha = score;
+            }
+        }
+    }
+
+    if (in_check && move_count == 0)
+    {
+        return -SCORE_MATE + m_ply;
+    }
+
+    return best_score;
+}
+
+int Search::negamax(int alpha, int beta, int depth, bool null_allowed)
+{
+    if (depth <= 0)
+    {
+        return quiescence(alpha, beta);
+    }
+
+    m_pv_length[m_ply] = m_ply;
+
+    checkLimits();
+    if (m_stopped)
+    {
+        return 0;
+    }
+
+    ++m_nodes;
+
+    bool pv_node = beta - alpha > 1;
+    bool root = m_ply == 0;
+
+    if (!root)
+    {
+        if (m_position.isDraw(m_ply))
+        {
+            return 0;
+        }
+
+        if (m_ply >= MAX_PLY - 1)
+        {
+            return m_position.evaluate(&m_pawn_table);
+        }
+
+        // no line from here can beat a mate already found closer to the root
+        alpha = std::max(alpha, -SCORE_MATE + m_ply);
+        beta = std::min(beta, SCORE_MATE - m_ply - 1);
+
+        if (alpha >= beta)
+        {
+            return alpha;
+        }
+    }
+
+    std::uint64_t key = m_position.getHash();
+
+    TTData tt;
+    bool tt_hit = m_tt.probe(key, tt);
+    Move tt_move = tt_hit ? tt.move : NO_MOVE;
+
+    if (!pv_node && tt_hit && tt.depth >= depth)
+    {
+        int score = scoreFromTT(tt.score, m_ply);
+
+        if (tt.bound == Bound::Exact || (tt.bound == Bound::Lower && score >= beta) ||
+                (tt.bound == Bound::Upper && score <= alpha))
+        {
+            return score;
+        }
+    }
+
+    bool in_check = m_position.inCheck();
+    int static_eval = -SCORE_INFINITE;
+
+    if (in_check)
+    {
+        ++depth;
+    }
+
+    else
+    {
+        static_eval = tt_hit ? tt.eval : m_position.evaluate(&m_pawn_table);
+    }
+
+    // give the opponent a free move, if we are still above beta the node is not worth searching
+    if (!pv_node && !in_check && null_allowed && depth >= 3 && static_eval >= beta && m_position.hasNonPawnMaterial())
+    {
+        int reduction = 3 + depth / 6;
+
+        m_position.doNullMove();
+        ++m_ply;
+
+        int score = -negamax(-beta, -beta + 1, depth - 1 - reduction, false);
+
+        --m_ply;
+        m_position.undoNullMove();
+
+        if (m_stopped)
+        {
+            return 0;
+        }
+
+        if (score >= beta)
+        {
+            return score >= SCORE_MATE_IN_MAX_PLY ? beta : score;
+        }
+    }
+
+    const Move no_killers[2] = {NO_MOVE, NO_MOVE};
+    Move previous = m_position.lastMove();
+    Move counter_move = previous != NO_MOVE ? m_counter_moves[previous.from][previous.to] : NO_MOVE;
+
+    MovePicker picker = m_limits.quiet_ordering ?
+            MovePicker(m_position, tt_move, m_killers[m_ply], counter_move, &m_history) :
+            MovePicker(m_position, tt_move, no_killers, NO_MOVE, nullptr);
+
+    int best_score = -SCORE_INFINITE;
+    Move best_move = NO_MOVE;
+    int move_count = 0;
+
+    Move quiets_tried[64];
+    int quiet_count = 0;
+    Move move;
+
+    while ((move = picker.next()) != NO_MOVE)
+    {
+        ++move_count;
+
+        bool quiet = !m_position.isCapture(move) && move.type != MoveType::Promote;
+
+        m_position.doMove(move);
+        m_tt.prefetch(m_position.getHash());
+        ++m_ply;
+
+        bool gives_check = m_position.inCheck();
+        int score;
+
+        if (move_count == 1)
+        {
+            score = -negamax(-beta, -alpha, depth - 1, true);
+        }
+
+        else
+        {
+            int reduction = 0;
+
+            if (depth >= 3 && move_count > 3 && quiet && !in_check && !gives_check)
+            {
+                reduction = reductions[std::min(depth, MAX_PLY - 1)][move_count] - pv_node;
+                reduction = std::max(0, std::min(reduction, depth - 2));
+            }
+
+            // zero window first, widened only when the move looks better than what we have
+            score = -negamax(-alpha - 1, -alpha, depth - 1 - reduction, true);
+
+            if (score > alpha && reduction > 0)
+            {
+                score = -negamax(-alpha - 1, -alpha, depth - 1, true);
+            }
+
+            if (score > alpha && score < beta)
+            {
+                score = -negamax(-beta, -alpha, depth - 1, true);
+            }
+        }
+
+        --m_ply;
+        m_position.undoMove();
+
+        if (m_stopped)
+        {
+            return 0;
+        }
+
+        if (score > best_score)
+        {
+            best_score = score;
+
+            if (score > alpha)
+            {
+                best_move = move;
+                updatePv(move);
+
+                if (score >= beta)
+                {
+                    if (quiet && m_limits.quiet_ordering)
+                    {
+                        updateQuietStats(move, depth, quiets_tried, quiet_count);
+                    }
+
+                    break;
+                }
+
+                alpha = score;
+            }
+        }
+
+        if (quiet && quiet_count < 64)
+        {
+            quiets_tried[quiet_count++] = move;
+        }
+    }
+
+    if (move_count == 0)
+    {
+        return in_check ? -SCORE_MATE + m_ply : 0;
+    }
+
+    Bound bound = Bound::Upper;
+    if (best_score >= beta)
+    {
+        bound = Bound::Lower;
+    }
+
+    else if (best_move != NO_MOVE)
+    {
+        bound = Bound::Exact;
+    }
+
+    m_tt.store(key, {best_move, scoreToTT(best_score, m_ply), static_eval, depth, bound});
+
+    return best_score;
+}
+
+SearchResult Search::run(const SearchLimits& limits)
+{
+    m_limits = limits;
+    m_start = std::chrono::steady_clock::now();
+
+    m_tt.newSearch();
+
+    m_helpers.clear();
+    std::vector<std::thread> threads;
+
+    for (int i = 1; i < limits.threads; ++i)
+    {
+        m_helpers.emplace_back(new Search(m_position, m_tt, i, m_stop_signal));
+        m_helpers.back()->m_limits = limits;
+        m_helpers.back()->m_start = m_start;
+    }
+
+    std::vector<SearchResult> results(m_helpers.size());
+    for (std::size_t i = 0; i < m_helpers.size(); ++i)
+    {
+        Search* helper = m_helpers[i].get();
+        threads.emplace_back([helper, &results, i]() { results[i] = helper->iterate(); });
+    }
+
+    SearchResult result = iterate();
+
+    stop();
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    m_helpers.clear();
+
+    // cleared only now, so a stop() from another thread before the search even started still counts
+    m_stop_signal->store(false, std::memory_order_relaxed);
+
+    // the deepest completed iteration wins, the main thread on ties
+    for (const SearchResult& helper : results)
+    {
+        result.nodes += helper.nodes;
+
+        if (helper.depth > result.depth && helper.best_move != NO_MOVE)
+        {
+            result.best_move = helper.best_move;
+            result.score = helper.score;
+            result.depth = helper.depth;
+            result.pv = helper.pv;
+        }
+    }
+
+    return result;
+}
+
+SearchResult Search::iterate()
+{
+    m_nodes = 0;
+    m_stopped = false;
+    m_ply = 0;
+
+    SearchResult result;
+
+    MoveList root_moves;
+    m_position.generateMoves(root_moves);
+
+    if (root_moves.size() == 0)
+    {
+        result.score = m_position.inCheck() ? -SCORE_MATE : 0;
+        return result;
+    }
+
+    result.best_move = root_moves[0];
+
+    int score = 0;
+
+    for (int depth = 1; depth <= m_limits.depth && depth < MAX_PLY; ++depth)
+    {
+        if (skipDepth(depth))
+        {
+            continue;
+        }
+
+        int delta = 25;
+        int alpha = -SCORE_INFINITE;
+        int beta = SCORE_INFINITE;
+
+        if (depth >= 4)
+        {
+            alpha = std::max(score - delta, -SCORE_INFINITE);
+            beta = std::min(score + delta, SCORE_INFINITE);
+        }
+
+        // aspiration window around the last score, widened on every fail
+        while (true)
+        {
+            score = negamax(alpha, beta, depth, false);
+
+            if (m_stopped)
+            {
+                break;
+            }
+
+            if (score <= alpha)
+            {
+                beta = (alpha + beta) / 2;
+                alpha = std::max(score - delta, -SCORE_INFINITE);
+            }
+
+            else if (score >= beta)
+            {
+                beta = std::min(score + delta, SCORE_INFINITE);
+            }
+
+            else
+            {
+                break;
+            }
+
+            delta += delta / 2;
+        }
+
+        if (m_stopped)
+        {
+            break;
+        }
+
+        result.best_move = m_pv[0][0];
+        result.score = score;
+        result.depth = depth;
+        result.pv.assign(m_pv[0], m_pv[0] + m_pv_length[0]);
+
+        if (m_thread_id == 0 && m_info)
+        {
+            result.nodes = totalNodes();
+            result.time = elapsed();
+            m_info(result);
+        }
+    }
+
+    result.nodes = m_nodes;
+    result.time = elapsed();
+
+    return result;
+}
@@ -0,0 +1,101 @@
+#include <algorithm>
+#include "chess.h"
+
+// Static exchange evaluation: the material the side to move wins, in centipawns,
+// if both sides keep recapturing on the target square with their least valuable
+// attacker and may stop whenever going on would lose. Sliders behind a capturer
+// join in as it leaves the line. Pins are not looked at.
+int Chess::see(const Move& move) const
+{
+    if (move.type == MoveType::CastleLeft || move.type == MoveType::CastleRight)
+    {
+        return 0;
+    }
+
+    const Bitboard bishops_queens = m_board.pieces[0][2] | m_board.pieces[1][2] | m_board.pieces[0][4] | m_board.pieces[1][4];
+    const Bitboard rooks_queens = m_board.pieces[0][3] | m_board.pieces[1][3] | m_board.pieces[0][4] | m_board.pieces[1][4];
+
+    int from = move.from;
+    int to = move.to;
+    int side = static_cast<int>(m_player_turn);
+
+    Bitboard occupied = m_board.all ^ squareBit(from);
+    int victim = pieceTypeOn(to);
+
+    if (move.type == MoveType::Passant)
+    {
+        victim = static_cast<int>(FigureType::Pawn);
+        occupied ^= squareBit((side == 0) ? to - 8 : to + 8);
+    }
+
+    // gain[d] is what the side making capture d has won once it is made
+    int gain[32];
+    int depth = 0;
+
+    gain[0] = victim == NO_PIECE ? 0 : 100 * piece_value[victim];
+    int on_square = 100 * piece_value[pieceTypeOn(from)];
+
+    if (move.type == MoveType::Promote)
+    {
+        gain[0] += 100 * (piece_value[static_cast<int>(move.promote)] - piece_value[0]);
+        on_square = 100 * piece_value[static_cast<int>(move.promote)];
+    }
+
+    Bitboard attackers = attackersTo(to, occupied) & occupied;
+
+    while (true)
+    {
+        side ^= 1;
+
+        Bitboard ours = attackers & m_board.occupancy[side];
+        if (!ours || depth == 31)
+        {
+            break;
+        }
+
+        int type = 0;
+        while (!(ours & m_board.pieces[side][type]))
+        {
+            ++type;
+        }
+
+        // the king may only take last, when nothing can take it back
+        if (type == static_cast<int>(FigureType::King) && (attackers & m_board.occupancy[side ^ 1]))
+        {
+            break;
+        }
+
+        ++depth;
+        gain[depth] = on_square - gain[depth - 1];
+
+        // this capture would lose whether or not it is answered, so it is not made
+        if (std::max(-gain[depth - 1], gain[depth]) < 0)
+        {
+            --depth;
+            break;
+        }
+
+        occupied ^= squareBit(lsb(ours & m_board.pieces[side][type]));
+
+        if (type == 0 || type == 2 || type == 4)
+        {
+            attackers |= bishopAttacks(to, occupied) & bishops_queens;
+        }
+
+        if (type == 3 || type == 4)
+        {
+            attackers |= rookAttacks(to, occupied) & rooks_queens;
+        }
+
+        attackers &= occupied;
+        on_square = 100 * piece_value[type];
+    }
+
+    while (depth > 0)
+    {
+        gain[depth - 1] = -std::max(-gain[depth - 1], gain[depth]);
+        --depth;
+    }
+
+    return gain[0];
+}
@@ -0,0 +1,142 @@
+#ifndef SORTEDRUNS_H
+#define SORTEDRUNS_H
+
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// the most run files a merge keeps open at once, more are merged in passes
+constexpr std::size_t RUN_MERGE_FILES = 64;
+
+// Sorting more records than fit in memory: callers sort what fits and hand it
+// over as a run, which goes to a temporary file named after prefix. merge()
+// reads them all back in order. Records are written as they are in memory.
+template <typename Record>
+class SortedRuns {
+    static_assert(std::is_trivially_copyable<Record>::value, "runs are raw copies of the records");
+
+    private:
+        std::string m_prefix;
+        std::vector<std::string> m_paths; // runs not merged yet
+        int m_created;
+        bool m_ok;
+        std::mutex m_mutex;
+
+        std::string newPath()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_prefix + ".run" + std::to_string(m_created++);
+        }
+
+        // merges the runs in paths, removing their files, handing every record to sink
+        template <typename Less, typename Sink>
+        bool mergeFiles(const std::vector<std::string>& paths, Less less, Sink sink)
+        {
+            std::vector<std::ifstream> inputs(paths.size());
+            std::vector<Record> heads(paths.size());
+            bool ok = true;
+
+            auto later = [&heads, &less](std::size_t a, std::size_t b)
+            {
+                return less(heads[b], heads[a]);
+            };
+            std::priority_queue<std::size_t, std::vector<std::size_t>, decltype(later)> queue(later);
+
+            for (std::size_t i = 0; i < paths.size(); ++i)
+            {
+                inputs[i].open(paths[i], std::ios::binary);
+                ok = ok && inputs[i].is_open();
+
+                if (inputs[i].read(reinterpret_cast<char*>(&heads[i]), sizeof(Record)))
+                {
+                    queue.push(i);
+                }
+            }
+
+            while (ok && !queue.empty())
+            {
+                std::size_t run = queue.top();
+                queue.pop();
+
+                Record record = heads[run];
+                if (inputs[run].read(reinterpret_cast<char*>(&heads[run]), sizeof(Record)))
+                {
+                    queue.push(run);
+                }
+
+                sink(record);
+            }
+
+            for (std::size_t i = 0; i < paths.size(); ++i)
+            {
+                inputs[i].close();
+                std::remove(paths[i].c_str());
+            }
+
+            return ok;
+        }
+
+    public:
+        explicit SortedRuns(const std::string& prefix) : m_prefix(prefix), m_created(0), m_ok(true) {}
+
+        ~SortedRuns()
+        {
+            for (const std::string& path : m_paths)
+            {
+                std::remove(path.c_str());
+            }
+        }
+
+        SortedRuns(const SortedRuns&) = delete;
+        SortedRuns& operator=(const SortedRuns&) = delete;
+
+        // records must already be sorted; safe to call from several threads
+        void add(const std::vector<Record>& records)
+        {
+            std::string path = newPath();
+            std::ofstream run(path, std::ios::binary | std::ios::trunc);
+            run.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(Record));
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_paths.push_back(path);
+            m_ok = m_ok && static_cast<bool>(run);
+        }
+
+        // Every record of every run in less order, passed to sink(const Record&).
+        // False when a run could not be written or read back.
+        template <typename Less, typename Sink>
+        bool merge(Less less, Sink sink)
+        {
+            while (m_ok && m_paths.size() > RUN_MERGE_FILES)
+            {
+                std::vector<std::string> group(m_paths.begin(), m_paths.begin() + RUN_MERGE_FILES);
+                m_paths.erase(m_paths.begin(), m_paths.begin() + RUN_MERGE_FILES);
+
+                std::string path = newPath();
+                std::ofstream run(path, std::ios::binary | std::ios::trunc);
+                m_paths.push_back(path);
+
+                m_ok = mergeFiles(group, less, [&run](const Record& record)
+                {
+                    run.write(reinterpret_cast<const char*>(&record), sizeof(Record));
+                }) && static_cast<bool>(run);
+            }
+
+            if (!m_ok)
+            {
+                return false;
+            }
+
+            std::vector<std::string> last;
+            last.swap(m_paths);
+
+            return mergeFiles(last, less, sink) && m_ok;
+        }
+};
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef TT_H
+#define TT_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "chess.h"
+
+enum class Bound : std::uint8_t {
+    None, Upper, Lower, Exact
+};
+
+// what a probe hands back to the search
+struct TTData {
+    Move move;
+    int score;
+    int eval;
+    int depth;
+    Bound bound;
+};
+
+// Hash table shared by all search threads without locks. Every entry is two
+// 64-bit words written with relaxed atomics, the first holding key ^ data,
+// so a torn write from another thread fails the key check and reads as a miss.
+class TranspositionTable {
+    private:
+        struct Entry {
+            std::atomic<std::uint64_t> key; // hash ^ data
+            std::atomic<std::uint64_t> data;
+        };
+
+        static constexpr int BUCKET_SIZE = 4;
+
+        struct alignas(64) Bucket {
+            Entry entries[BUCKET_SIZE];
+        };
+
+        Bucket* m_buckets;
+        std::size_t m_bucket_count;
+        void* m_memory; // as allocated; mapped memory is over-allocated and m_buckets starts at its first huge page
+        std::size_t m_allocated; // bytes
+        bool m_huge_pages;
+        std::uint8_t m_generation; // 6 bits, bumped by every new search
+
+        static std::uint64_t packData(const TTData& data, std::uint8_t generation);
+        static TTData unpackData(std::uint64_t data);
+        static int generationOf(std::uint64_t data);
+        static int depthOf(std::uint64_t data);
+
+        Bucket& bucket(std::uint64_t key) const;
+
+        void release();
+
+    public:
+        explicit TranspositionTable(std::size_t mb = 16, bool huge_pages = false);
+        ~TranspositionTable();
+
+        TranspositionTable(const TranspositionTable&) = delete;
+        TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+        bool resize(std::size_t mb, bool huge_pages = false);
+        void clear();
+        void newSearch();
+
+        bool probe(std::uint64_t key, TTData& data) const;
+        void store(std::uint64_t key, const TTData& data);
+        void prefetch(std::uint64_t key) const;
+
+        int hashfull() const; // per mille of sampled entries written by the current search
+        std::size_t size() const; // bytes
+};
+
+#endif
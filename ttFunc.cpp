@@ -0,0 +1,257 @@
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include "tt.h"
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+// data word layout: move 16 | score 16 | eval 16 | depth 8 | bound 2 | generation 6
+constexpr int DEPTH_OFFSET = 8; // lets quiescence entries store depths down to -8
+
+TranspositionTable::TranspositionTable(std::size_t mb, bool huge_pages) :
+    m_buckets(nullptr), m_bucket_count(0), m_memory(nullptr), m_allocated(0), m_huge_pages(false), m_generation(0)
+{
+    resize(mb, huge_pages);
+}
+
+TranspositionTable::~TranspositionTable()
+{
+    release();
+}
+
+void TranspositionTable::release()
+{
+    if (m_memory)
+    {
+#ifdef __linux__
+        if (m_huge_pages)
+        {
+            munmap(m_memory, m_allocated);
+        }
+
+        else
+#endif
+        {
+            std::free(m_memory);
+        }
+    }
+
+    m_buckets = nullptr;
+    m_bucket_count = 0;
+    m_memory = nullptr;
+    m_allocated = 0;
+}
+
+// Huge pages are only a request: when the kernel refuses, normal pages are used.
+// mmap only promises 4 KB alignment, so a mapping gets one huge page extra and
+// the table starts at the first 2 MB boundary inside it, where the kernel can
+// back every huge page of the table.
+bool TranspositionTable::resize(std::size_t mb, bool huge_pages)
+{
+    std::size_t bucket_count = mb * 1024 * 1024 / sizeof(Bucket);
+    if (bucket_count == 0)
+    {
+        bucket_count = 1;
+    }
+
+    std::size_t bytes = bucket_count * sizeof(Bucket);
+    void* memory = nullptr;
+    void* table = nullptr;
+    bool mapped = false;
+
+#ifdef __linux__
+    if (huge_pages)
+    {
+        const std::size_t huge_page = 2 * 1024 * 1024;
+        std::size_t table_bytes = (bytes + huge_page - 1) / huge_page * huge_page;
+        bytes = table_bytes + huge_page;
+
+        memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED)
+        {
+            memory = nullptr;
+        }
+
+        else
+        {
+            std::uintptr_t base = reinterpret_cast<std::uintptr_t>(memory);
+            table = reinterpret_cast<void*>((base + huge_page - 1) / huge_page * huge_page);
+
+            madvise(table, table_bytes, MADV_HUGEPAGE);
+            mapped = true;
+        }
+    }
+#endif
+
+    if (!memory)
+    {
+        bytes = bucket_count * sizeof(Bucket);
+        memory = std::aligned_alloc(alignof(Bucket), bytes);
+        table = memory;
+    }
+
+    if (!memory)
+    {
+        return false;
+    }
+
+    release();
+
+    m_buckets = static_cast<Bucket*>(table);
+    m_bucket_count = bucket_count;
+    m_memory = memory;
+    m_allocated = bytes;
+    m_huge_pages = mapped;
+
+    for (std::size_t i = 0; i < m_bucket_count; ++i)
+    {
+        new (&m_buckets[i]) Bucket;
+    }
+
+    clear();
+    return true;
+}
+
+void TranspositionTable::clear()
+{
+    for (std::size_t i = 0; i < m_bucket_count; ++i)
+    {
+        for (Entry& entry : m_buckets[i].entries)
+        {
+            entry.key.store(0, std::memory_order_relaxed);
+            entry.data.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    m_generation = 0;
+}
+
+void TranspositionTable::newSearch()
+{
+    m_generation = (m_generation + 1) & 63;
+}
+
+std::uint64_t TranspositionTable::packData(const TTData& data, std::uint8_t generation)
+{
+    return static_cast<std::uint64_t>(data.move.pack()) |
+            static_cast<std::uint64_t>(static_cast<std::uint16_t>(data.score)) << 16 |
+            static_cast<std::uint64_t>(static_cast<std::uint16_t>(data.eval)) << 32 |
+            static_cast<std::uint64_t>(static_cast<std::uint8_t>(data.depth + DEPTH_OFFSET)) << 48 |
+            static_cast<std::uint64_t>(data.bound) << 56 |
+            static_cast<std::uint64_t>(generation) << 58;
+}
+
+TTData TranspositionTable::unpackData(std::uint64_t data)
+{
+    return {Move::unpack(static_cast<std::uint16_t>(data)),
+        static_cast<std::int16_t>(data >> 16),
+        static_cast<std::int16_t>(data >> 32),
+        depthOf(data),
+        static_cast<Bound>((data >> 56) & 3)};
+}
+
+int TranspositionTable::generationOf(std::uint64_t data)
+{
+    return static_cast<int>(data >> 58);
+}
+
+int TranspositionTable::depthOf(std::uint64_t data)
+{
+    return static_cast<int>((data >> 48) & 255) - DEPTH_OFFSET;
+}
+
+TranspositionTable::Bucket& TranspositionTable::bucket(std::uint64_t key) const
+{
+    // high half of the 128-bit product maps the key onto any bucket count without a modulo
+    std::size_t index = static_cast<std::size_t>((static_cast<unsigned __int128>(key) * m_bucket_count) >> 64);
+    return m_buckets[index];
+}
+
+void TranspositionTable::prefetch(std::uint64_t key) const
+{
+    __builtin_prefetch(&bucket(key));
+}
+
+bool TranspositionTable::probe(std::uint64_t key, TTData& data) const
+{
+    for (const Entry& entry : bucket(key).entries)
+    {
+        std::uint64_t word = entry.data.load(std::memory_order_relaxed);
+
+        if ((entry.key.load(std::memory_order_relaxed) ^ word) == key)
+        {
+            data = unpackData(word);
+            return data.bound != Bound::None;
+        }
+    }
+
+    return false;
+}
+
+// same position overwrites in place, otherwise the shallowest and oldest entry makes room
+void TranspositionTable::store(std::uint64_t key, const TTData& data)
+{
+    Bucket& slot = bucket(key);
+    Entry* replace = &slot.entries[0];
+    int worst = 1 << 30;
+
+    TTData stored = data;
+
+    for (Entry& entry : slot.entries)
+    {
+        std::uint64_t word = entry.data.load(std::memory_order_relaxed);
+
+        if ((entry.key.load(std::memory_order_relaxed) ^ word) == key)
+        {
+            if (stored.move == NO_MOVE)
+            {
+                stored.move = Move::unpack(static_cast<std::uint16_t>(word));
+            }
+
+            replace = &entry;
+            break;
+        }
+
+        int age = (m_generation - generationOf(word)) & 63;
+        int value = depthOf(word) - 8 * age;
+
+        if (value < worst)
+        {
+            worst = value;
+            replace = &entry;
+        }
+    }
+
+    std::uint64_t word = packData(stored, m_generation);
+
+    replace->key.store(key ^ word, std::memory_order_relaxed);
+    replace->data.store(word, std::memory_order_relaxed);
+}
+
+int TranspositionTable::hashfull() const
+{
+    std::size_t samples = m_bucket_count < 1000 ? m_bucket_count : 1000;
+    int used = 0;
+
+    for (std::size_t i = 0; i < samples; ++i)
+    {
+        for (const Entry& entry : m_buckets[i].entries)
+        {
+            std::uint64_t word = entry.data.load(std::memory_order_relaxed);
+
+            if (generationOf(word) == m_generation && static_cast<Bound>((word >> 56) & 3) != Bound::None)
+            {
+                ++used;
+            }
+        }
+    }
+
+    return samples ? static_cast<int>(used * 1000 / (samples * BUCKET_SIZE)) : 0;
+}
+
+std::size_t TranspositionTable::size() const
+{
+    return m_bucket_count * sizeof(Bucket);
+}
@@ -0,0 +1,55 @@
+#ifndef UCI_H
+#define UCI_H
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include "chess.h"
+#include "polyglot.h"
+#include "search.h"
+
+// Universal Chess Interface over stdin/stdout, for GUIs and tournament managers.
+// Commands are read on the calling thread while a search runs on its own, so
+// "stop", "isready" and "quit" are answered at once.
+class Uci {
+    private:
+        Chess m_position;
+        TranspositionTable m_tt;
+        int m_hash_mb;
+        bool m_large_pages; // ask for 2 MB pages for the hash table, where the system has them
+        int m_threads;
+        PolyglotBook m_book; // answers "go" before any search while the position is in it
+
+        std::unique_ptr<Search> m_search;
+        std::thread m_search_thread;
+
+        // "go infinite" holds bestmove back until "stop" even when the search ends first
+        std::mutex m_stop_mutex;
+        std::condition_variable m_stop_condition;
+        bool m_stop_requested;
+        bool m_infinite; // the running search was started by "go infinite"
+
+        std::mutex m_output_mutex; // info lines from the search thread, replies from this one
+
+        void send(const std::string& line);
+
+        void position(std::istringstream& args);
+        void go(std::istringstream& args);
+        void setOption(std::istringstream& args);
+        void stopSearch(); // stops a running search and waits for its bestmove
+
+        void sendInfo(const SearchResult& result);
+
+        static std::string scoreString(int score);
+
+    public:
+        Uci();
+        ~Uci();
+
+        int loop(); // until "quit" or end of input
+};
+
+#endif
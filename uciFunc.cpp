@@ -0,0 +1,347 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include "uci.h"
+
+constexpr int DEFAULT_HASH_MB = 64;
+constexpr int MAX_HASH_MB = 65536;
+constexpr int MAX_THREADS = 256;
+
+Uci::Uci() : m_tt(DEFAULT_HASH_MB), m_hash_mb(DEFAULT_HASH_MB), m_large_pages(false), m_threads(1),
+    m_stop_requested(false), m_infinite(false) {}
+
+Uci::~Uci()
+{
+    stopSearch();
+}
+
+void Uci::send(const std::string& line)
+{
+    std::lock_guard<std::mutex> lock(m_output_mutex);
+    std::cout << line << std::endl;
+}
+
+// centipawns, or moves to mate with the sign of the side that mates
+std::string Uci::scoreString(int score)
+{
+    if (score >= SCORE_MATE_IN_MAX_PLY)
+    {
+        return "mate " + std::to_string((SCORE_MATE - score + 1) / 2);
+    }
+
+    if (score <= -SCORE_MATE_IN_MAX_PLY)
+    {
+        return "mate -" + std::to_string((SCORE_MATE + score) / 2);
+    }
+
+    return "cp " + std::to_string(score);
+}
+
+void Uci::sendInfo(const SearchResult& result)
+{
+    std::ostringstream line;
+
+    line << "info depth " << result.depth << " score " << scoreString(result.score) << " nodes " << result.nodes
+        << " nps " << result.nodes * 1000 / std::max<std::int64_t>(result.time, 1) << " time " << result.time
+        << " hashfull " << m_tt.hashfull() << " pv";
+
+    for (const Move& move : result.pv)
+    {
+        line << ' ' << Chess::moveToString(move);
+    }
+
+    send(line.str());
+}
+
+// position [startpos | fen <fen>] [moves <move>...]
+void Uci::position(std::istringstream& args)
+{
+    std::string token;
+    args >> token;
+
+    Chess position;
+
+    if (token == "fen")
+    {
+        std::string fen;
+        while (args >> token && token != "moves")
+        {
+            fen += token + ' ';
+        }
+
+        if (!position.fromFEN(fen))
+        {
+            send("info string invalid fen " + fen);
+            return;
+        }
+    }
+
+    else if (token == "startpos")
+    {
+        args >> token;
+    }
+
+    else
+    {
+        return;
+    }
+
+    // the moves are played, not set up, so repetitions before the root are known to the search
+    if (token == "moves")
+    {
+        while (args >> token)
+        {
+            if (!position.tryMove(token))
+            {
+                send("info string illegal move " + token);
+                break;
+            }
+        }
+    }
+
+    m_position = position;
+}
+
+// go [depth n] [nodes n] [movetime ms] [wtime ms] [btime ms] [winc ms] [binc ms] [movestogo n] [infinite]
+void Uci::go(std::istringstream& args)
+{
+    stopSearch();
+
+    SearchLimits limits;
+    limits.threads = m_threads;
+
+    int time[2] = {0, 0};
+    int increment[2] = {0, 0};
+    int moves_to_go = 0;
+    bool infinite = false;
+
+    std::string token;
+    while (args >> token)
+    {
+        if (token == "depth")
+        {
+            args >> limits.depth;
+            limits.depth = std::min(std::max(limits.depth, 1), MAX_PLY - 1);
+        }
+        else if (token == "nodes")
+        {
+            args >> limits.nodes;
+        }
+        else if (token == "movetime")
+        {
+            args >> limits.movetime;
+        }
+        else if (token == "wtime")
+        {
+            args >> time[0];
+        }
+        else if (token == "btime")
+        {
+            args >> time[1];
+        }
+        else if (token == "winc")
+        {
+            args >> increment[0];
+        }
+        else if (token == "binc")
+        {
+            args >> increment[1];
+        }
+        else if (token == "movestogo")
+        {
+            args >> moves_to_go;
+        }
+        else if (token == "infinite")
+        {
+            infinite = true;
+        }
+    }
+
+    // on a clock: an even share of what is left plus most of the increment, never the last 50ms
+    int us = static_cast<int>(m_position.getPlayerType());
+    if (!limits.movetime && !infinite && time[us] > 0)
+    {
+        int share = time[us] / (moves_to_go > 0 ? moves_to_go : 30) + increment[us] * 3 / 4;
+        limits.movetime = std::max(1, std::min(share, time[us] - 50));
+    }
+
+    // a book move is played at once, except when asked to analyse
+    Move book_move = infinite ? NO_MOVE : m_book.pick(m_position);
+    if (book_move != NO_MOVE)
+    {
+        send("bestmove " + Chess::moveToString(book_move));
+        return;
+    }
+
+    m_stop_requested = false;
+    m_infinite = infinite;
+    m_search.reset(new Search(m_position, m_tt));
+    m_search->setInfoCallback([this](const SearchResult& result) { sendInfo(result); });
+
+    m_search_thread = std::thread([this, limits, infinite]()
+    {
+        SearchResult result = m_search->run(limits);
+
+        if (infinite)
+        {
+            std::unique_lock<std::mutex> lock(m_stop_mutex);
+            m_stop_condition.wait(lock, [this]() { return m_stop_requested; });
+        }
+
+        std::string line = "bestmove " + (result.best_move == NO_MOVE ? "0000" : Chess::moveToString(result.best_move));
+        if (result.pv.size() > 1)
+        {
+            line += " ponder " + Chess::moveToString(result.pv[1]);
+        }
+
+        send(line);
+    });
+}
+
+// setoption name <Hash | Threads> value <n>, setoption name LargePages value <true | false>,
+// setoption name BookFile value <path | <empty>>
+void Uci::setOption(std::istringstream& args)
+{
+    std::string token;
+    std::string name;
+    std::string value;
+
+    args >> token >> name >> token;
+    std::getline(args >> std::ws, value);
+
+    if (name == "Hash" || name == "LargePages")
+    {
+        int mb = m_hash_mb;
+        bool large_pages = m_large_pages;
+
+        if (name == "Hash")
+        {
+            mb = std::min(std::max(std::atoi(value.c_str()), 1), MAX_HASH_MB);
+        }
+
+        else
+        {
+            large_pages = value == "true";
+        }
+
+        // a failed resize keeps the old table
+        stopSearch();
+        if (!m_tt.resize(mb, large_pages))
+        {
+            send("info string cannot allocate " + std::to_string(mb) + " MB of hash, keeping " +
+                std::to_string(m_hash_mb) + " MB");
+            return;
+        }
+
+        m_hash_mb = mb;
+        m_large_pages = large_pages;
+    }
+
+    else if (name == "Threads")
+    {
+        m_threads = std::min(std::max(std::atoi(value.c_str()), 1), MAX_THREADS);
+    }
+
+    else if (name == "BookFile")
+    {
+        m_book.close();
+        if (!value.empty() && value != "<empty>" && !m_book.open(value))
+        {
+            send("info string cannot load " + value);
+        }
+    }
+
+    else
+    {
+        send("info string unknown option " + name);
+    }
+}
+
+void Uci::stopSearch()
+{
+    if (!m_search_thread.joinable())
+    {
+        return;
+    }
+
+    m_search->stop();
+
+    {
+        std::lock_guard<std::mutex> lock(m_stop_mutex);
+        m_stop_requested = true;
+    }
+    m_stop_condition.notify_one();
+
+    m_search_thread.join();
+}
+
+int Uci::loop()
+{
+    std::string line;
+
+    while (std::getline(std::cin, line))
+    {
+        std::istringstream args(line);
+        std::string command;
+        args >> command;
+
+        if (command == "uci")
+        {
+            send("id name Chess");
+            send("option name Hash type spin default " + std::to_string(DEFAULT_HASH_MB) + " min 1 max " +
+                std::to_string(MAX_HASH_MB));
+            send("option name LargePages type check default false");
+            send("option name Threads type spin default 1 min 1 max " + std::to_string(MAX_THREADS));
+            send("option name BookFile type string default <empty>");
+            send("uciok");
+        }
+
+        else if (command == "isready")
+        {
+            send("readyok");
+        }
+
+        else if (command == "ucinewgame")
+        {
+            stopSearch();
+            m_tt.clear();
+            m_position = Chess();
+        }
+
+        else if (command == "position")
+        {
+            stopSearch();
+            position(args);
+        }
+
+        else if (command == "go")
+        {
+            go(args);
+        }
+
+        else if (command == "stop")
+        {
+            stopSearch();
+        }
+
+        else if (command == "setoption")
+        {
+            setOption(args);
+        }
+
+        else if (command == "quit")
+        {
+            stopSearch();
+            return 0;
+        }
+    }
+
+    // input ran out: a search with limits still gets to finish, as when commands are piped in
+    if (m_search_thread.joinable() && !m_infinite)
+    {
+        m_search_thread.join();
+    }
+
+    stopSearch();
+    return 0;
+}
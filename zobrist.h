@@ -0,0 +1,57 @@
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include <cstdint>
+
+// random keys xored together to give every position a 64-bit hash
+struct ZobristKeys {
+    std::uint64_t piece[2][6][64]; // [FigureColor][FigureType][square]
+    std::uint64_t castle[16];      // indexed by the castle rights mask
+    std::uint64_t en_passant[8];   // by file of the en passant square
+    std::uint64_t side;            // xored in when black is to move
+};
+
+constexpr std::uint64_t splitMix64(std::uint64_t& state)
+{
+    std::uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+constexpr ZobristKeys makeZobristKeys()
+{
+    ZobristKeys keys = {};
+    std::uint64_t state = 0x5EED5EED2024ULL;
+
+    for (int color = 0; color < 2; ++color)
+    {
+        for (int type = 0; type < 6; ++type)
+        {
+            for (int square = 0; square < 64; ++square)
+            {
+                keys.piece[color][type][square] = splitMix64(state);
+            }
+        }
+    }
+
+    // no rights hashes to zero, so a position without castling needs no castle key
+    for (int rights = 1; rights < 16; ++rights)
+    {
+        keys.castle[rights] = splitMix64(state);
+    }
+
+    for (int file = 0; file < 8; ++file)
+    {
+        keys.en_passant[file] = splitMix64(state);
+    }
+
+    keys.side = splitMix64(state);
+
+    return keys;
+}
+
+// built by the compiler, nothing to initialize at startup
+inline constexpr ZobristKeys zobrist = makeZobristKeys();
+
+#endif